@@ -79,6 +79,7 @@ namespace {
 extern "C" EI_IMPULSE_ERROR run_inference(ei_impulse_handle_t *handle, ei_feature_t *fmatrix, ei_impulse_result_t *result, bool debug);
 extern "C" EI_IMPULSE_ERROR run_classifier_image_quantized(const ei_impulse_t *impulse, signal_t *signal, ei_impulse_result_t *result, bool debug);
 static EI_IMPULSE_ERROR can_run_classifier_image_quantized(const ei_impulse_t *impulse, ei_learning_block_t block_ptr);
+static EI_IMPULSE_ERROR can_run_classifier_spectral_quantized(const ei_impulse_t *impulse, ei_learning_block_t block_ptr);
 
 #if EI_CLASSIFIER_LOAD_IMAGE_SCALING
 EI_IMPULSE_ERROR ei_scale_fmatrix(ei_learning_block_t *block, ei::matrix_t *fmatrix);
@@ -251,6 +252,19 @@ extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
     }
 #endif
 
+#if EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE && EI_CLASSIFIER_COMPILED == 1
+    // Shortcut for quantized spectral analysis models, features are quantized into the input tensor
+    if (can_run_classifier_spectral_quantized(handle->impulse, handle->impulse->learning_blocks[0]) == EI_IMPULSE_OK) {
+        EI_IMPULSE_ERROR res = run_nn_inference_spectral_quantized(handle->impulse, signal, result,
+            handle->impulse->learning_blocks[0].config, debug);
+        if (res != EI_IMPULSE_OK) {
+            return res;
+        }
+        res = run_postprocessing(handle, result);
+        return res;
+    }
+#endif
+
 #ifndef EI_DSP_RESULT_OVERRIDE
     // Don't wipe in CI, as we store a pointer
     memset(result, 0, sizeof(ei_impulse_result_t));
@@ -381,6 +395,9 @@ extern "C" EI_IMPULSE_ERROR process_impulse(ei_impulse_handle_t *handle,
             }
             ei_printf("\n");
         }
+#if EIDSP_USE_SCRATCH_ARENA
+        ei_dsp_scratch_report();
+#endif
     }
 
     if (debug) {
@@ -470,8 +487,11 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
         else if (block.extract_fn == extract_mfe_features) {
             extract_fn_slice = &extract_mfe_per_slice_features;
         }
+        else if (block.extract_fn == extract_spectral_analysis_features) {
+            extract_fn_slice = &extract_spectral_analysis_per_slice_features;
+        }
         else {
-            ei_printf("ERR: Unknown extract function, only MFCC, MFE and spectrogram supported\n");
+            ei_printf("ERR: Unknown extract function, only MFCC, MFE, spectrogram and spectral analysis supported\n");
             return EI_IMPULSE_DSP_ERROR;
         }
 
@@ -578,6 +598,9 @@ extern "C" EI_IMPULSE_ERROR process_impulse_continuous(ei_impulse_handle_t *hand
                 ei_printf(" ");
             }
             ei_printf("\n");
+#if EIDSP_USE_SCRATCH_ARENA
+            ei_dsp_scratch_report();
+#endif
             ei_printf("Running impulse...\n");
         }
 
@@ -627,6 +650,49 @@ __attribute__((unused)) static EI_IMPULSE_ERROR can_run_classifier_image_quantiz
     return EI_IMPULSE_OK;
 }
 
+/**
+ * Check if the current impulse could be used by 'run_nn_inference_spectral_quantized'
+ * (EON compiled, int8 input, a single spectral analysis FFT v1 block feeding a single NN)
+ */
+__attribute__((unused)) static EI_IMPULSE_ERROR can_run_classifier_spectral_quantized(const ei_impulse_t *impulse, ei_learning_block_t block_ptr) {
+#if EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE && EI_CLASSIFIER_COMPILED == 1
+    if (impulse->inferencing_engine != EI_CLASSIFIER_TFLITE) {
+        return EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE;
+    }
+
+    // anomaly blocks need the float features
+    if (impulse->has_anomaly || impulse->learning_blocks_size != 1) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    if (block_ptr.infer_fn != run_nn_inference || block_ptr.image_scaling != EI_CLASSIFIER_IMAGE_SCALING_NONE) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    ei_learning_block_config_tflite_graph_t *block_config = (ei_learning_block_config_tflite_graph_t*)block_ptr.config;
+    if (block_config->quantized != 1) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    // stateless blocks only, a DSP handle keeps its own output
+    if (impulse->dsp_blocks_size != 1
+        || impulse->dsp_blocks[0].factory
+        || impulse->dsp_blocks[0].extract_fn != extract_spectral_analysis_features
+        || impulse->dsp_blocks[0].n_output_features != impulse->nn_input_frame_size) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    ei_dsp_config_spectral_analysis_t *dsp_config = (ei_dsp_config_spectral_analysis_t*)impulse->dsp_blocks[0].config;
+    if (dsp_config->implementation_version != 1 || strcmp(dsp_config->analysis_type, "FFT") != 0) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    return EI_IMPULSE_OK;
+#else
+    return EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE;
+#endif
+}
+
 #if EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TENSAIFLOW || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_DRPAI || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_ONNX_TIDL || EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_ATON)
 
 /**
@@ -803,6 +869,7 @@ extern "C" void run_classifier_init(void)
 
     classifier_continuous_features_written = 0;
     ei_dsp_clear_continuous_audio_state();
+    ei_dsp_clear_continuous_spectral_state();
     init_impulse(&ei_default_impulse);
     init_postprocessing(&ei_default_impulse);
 }
@@ -825,6 +892,7 @@ __attribute__((unused)) void run_classifier_init(ei_impulse_handle_t *handle)
 {
     classifier_continuous_features_written = 0;
     ei_dsp_clear_continuous_audio_state();
+    ei_dsp_clear_continuous_spectral_state();
     init_impulse(handle);
     init_postprocessing(handle);
 }
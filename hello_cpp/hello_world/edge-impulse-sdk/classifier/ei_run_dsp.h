@@ -60,6 +60,9 @@ static float *ei_dsp_cont_current_frame = nullptr;
 static size_t ei_dsp_cont_current_frame_size = 0;
 static int ei_dsp_cont_current_frame_ix = 0;
 
+// slices of the current window for continuous spectral analysis
+static spectral::spectral_slice_state_t ei_dsp_cont_spectral_state = { };
+
 __attribute__((unused)) int extract_hr_features(
     signal_t *signal,
     matrix_t *output_matrix,
@@ -93,6 +96,17 @@ __attribute__((unused)) int extract_spectral_analysis_features(
 
     signal->get_data(0, signal->total_length, input_matrix.buffer);
 
+#if EIDSP_USE_FIXED_POINT_SPECTRAL
+    if (spectral::fixed_point::supports(config)) {
+        feature_sink_t sink(output_matrix);
+        EI_TRY(spectral::fixed_point::extract_spectral_analysis_features_v1(&input_matrix, &sink, config, frequency));
+
+        output_matrix->cols = output_matrix->rows * output_matrix->cols;
+        output_matrix->rows = 1;
+        return EIDSP_OK;
+    }
+#endif
+
 #if EI_DSP_PARAMS_SPECTRAL_ANALYSIS_ANALYSIS_TYPE_WAVELET || EI_DSP_PARAMS_ALL
     if (strcmp(config->analysis_type, "Wavelet") == 0) {
         return spectral::wavelet::extract_wavelet_features(&input_matrix, output_matrix, config, frequency);
@@ -142,6 +156,55 @@ __attribute__((unused)) int extract_spectral_analysis_features(
     return EIDSP_NOT_SUPPORTED;
 }
 
+/**
+ * Per-slice version of extract_spectral_analysis_features, for run_classifier_continuous.
+ * Writes the features of the whole window every call; matrix_size_out stays 0x0 until a
+ * full window of slices has been seen. Only the v1 FFT analysis is supported.
+ */
+__attribute__((unused)) int extract_spectral_analysis_per_slice_features(
+    signal_t *signal,
+    matrix_t *output_matrix,
+    void *config_ptr,
+    const float frequency,
+    matrix_size_t *matrix_size_out)
+{
+    ei_dsp_config_spectral_analysis_t *config = (ei_dsp_config_spectral_analysis_t *)config_ptr;
+
+    matrix_size_out->rows = 0;
+    matrix_size_out->cols = 0;
+
+    if (config->implementation_version != 1 || strcmp(config->analysis_type, "FFT") != 0) {
+        ei_printf("ERR: Continuous spectral analysis only supports implementation version 1 with FFT\n");
+        EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+    }
+
+    // input matrix from the raw slice
+    matrix_t input_matrix(signal->total_length / config->axes, config->axes);
+    if (!input_matrix.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    signal->get_data(0, signal->total_length, input_matrix.buffer);
+
+    bool window_ready;
+    int ret = spectral::feature::extract_spectral_analysis_features_v1_slice(
+        &input_matrix,
+        output_matrix,
+        config,
+        frequency,
+        &ei_dsp_cont_spectral_state,
+        &window_ready);
+    if (ret != EIDSP_OK) {
+        return ret;
+    }
+
+    if (window_ready) {
+        matrix_size_out->rows = output_matrix->rows;
+        matrix_size_out->cols = output_matrix->cols;
+    }
+    return EIDSP_OK;
+}
+
 __attribute__((unused)) int extract_raw_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
     ei_dsp_config_raw_t config = *((ei_dsp_config_raw_t*)config_ptr);
 
@@ -1352,6 +1415,39 @@ __attribute__((unused)) int extract_image_features_quantized(signal_t *signal, m
     }
     return EIDSP_OK;
 }
+
+/**
+ * Spectral analysis (FFT, implementation version 1) quantized on write into an int8 matrix,
+ * normally the model's input tensor. Same features as extract_spectral_analysis_features
+ * followed by quantization with (scale, zero_point), without the float feature buffer.
+ */
+__attribute__((unused)) int extract_spectral_analysis_features_quantized(signal_t *signal, matrix_i8_t *output_matrix, void *config_ptr, float scale, float zero_point, const float frequency) {
+    ei_dsp_config_spectral_analysis_t *config = (ei_dsp_config_spectral_analysis_t *)config_ptr;
+
+    if (strcmp(config->analysis_type, "FFT") != 0 || config->implementation_version != 1) {
+        EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+    }
+
+    // input matrix from the raw signal
+    matrix_t input_matrix(signal->total_length / config->axes, config->axes);
+    if (!input_matrix.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    signal->get_data(0, signal->total_length, input_matrix.buffer);
+
+    ei::feature_sink_t sink(output_matrix, scale, static_cast<int32_t>(zero_point));
+#if EIDSP_USE_FIXED_POINT_SPECTRAL
+    if (spectral::fixed_point::supports(config)) {
+        return spectral::fixed_point::extract_spectral_analysis_features_v1(&input_matrix, &sink, config, frequency);
+    }
+#endif
+    return spectral::feature::extract_spectral_analysis_features_v1(
+        &input_matrix,
+        &sink,
+        config,
+        frequency);
+}
 #endif // (EI_CLASSIFIER_QUANTIZATION_ENABLED == 1) && (EI_CLASSIFIER_INFERENCING_ENGINE != EI_CLASSIFIER_DRPAI)
 
 /**
@@ -1369,6 +1465,12 @@ __attribute__((unused)) int ei_dsp_clear_continuous_audio_state() {
     return EIDSP_OK;
 }
 
+__attribute__((unused)) int ei_dsp_clear_continuous_spectral_state() {
+    spectral::feature::free_spectral_slice_state(&ei_dsp_cont_spectral_state);
+
+    return EIDSP_OK;
+}
+
 /**
  * @brief      Calculates the cepstral mean and variable normalization.
  *
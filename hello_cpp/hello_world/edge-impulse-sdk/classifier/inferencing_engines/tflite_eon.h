@@ -361,6 +361,111 @@ EI_IMPULSE_ERROR run_nn_inference_image_quantized(
 
     return EI_IMPULSE_OK;
 }
+
+/**
+ * Same idea for spectral analysis: the DSP block quantizes its features straight into the
+ * input tensor, so there is no float features buffer and no copy + quantize pass. This only
+ * works if 'can_run_classifier_spectral_quantized' returns EI_IMPULSE_OK.
+ */
+EI_IMPULSE_ERROR run_nn_inference_spectral_quantized(
+    const ei_impulse_t *impulse,
+    signal_t *signal,
+    ei_impulse_result_t *result,
+    void *config_ptr,
+    bool debug = false) {
+
+    ei_learning_block_config_tflite_graph_t *block_config = (ei_learning_block_config_tflite_graph_t*)config_ptr;
+    ei_config_tflite_eon_graph_t *graph_config = (ei_config_tflite_eon_graph_t*)block_config->graph_config;
+
+    memset(result, 0, sizeof(ei_impulse_result_t));
+
+    uint64_t ctx_start_us;
+    TfLiteTensor input;
+    TfLiteTensor output;
+    TfLiteTensor output_scores;
+    TfLiteTensor output_labels;
+
+    ei_unique_ptr_t p_tensor_arena(nullptr, ei_aligned_free);
+
+    EI_IMPULSE_ERROR init_res = inference_tflite_setup(
+        block_config,
+        &ctx_start_us,
+        &input, &output,
+        &output_labels,
+        &output_scores,
+        p_tensor_arena);
+
+    if (init_res != EI_IMPULSE_OK) {
+        return init_res;
+    }
+
+    if (input.type != TfLiteType::kTfLiteInt8) {
+        graph_config->model_reset(ei_aligned_free);
+        return EI_IMPULSE_ONLY_SUPPORTED_FOR_IMAGES;
+    }
+
+    const ei_model_dsp_t *dsp_block = &impulse->dsp_blocks[0];
+
+    uint64_t dsp_start_us = ei_read_timer_us();
+
+    // features matrix maps around the input tensor (only valid until model_reset)
+    ei::matrix_i8_t features_matrix(1, impulse->nn_input_frame_size, input.data.int8);
+
+#if EIDSP_SIGNAL_C_FN_POINTER
+    auto internal_signal = signal;
+#else
+    SignalWithAxes swa(signal, dsp_block->axes, dsp_block->axes_size, impulse);
+    auto internal_signal = swa.get_signal();
+#endif
+
+    // run DSP process and quantize automatically
+    int ret = extract_spectral_analysis_features_quantized(internal_signal, &features_matrix, dsp_block->config,
+        input.params.scale, input.params.zero_point, impulse->frequency);
+
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+        graph_config->model_reset(ei_aligned_free);
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
+        graph_config->model_reset(ei_aligned_free);
+        return EI_IMPULSE_CANCELED;
+    }
+
+    result->timing.dsp_us = ei_read_timer_us() - dsp_start_us;
+    result->timing.dsp = (int)(result->timing.dsp_us / 1000);
+
+    if (debug) {
+        ei_printf("Features (%d ms.): ", result->timing.dsp);
+        for (size_t ix = 0; ix < features_matrix.cols; ix++) {
+            ei_printf_float((features_matrix.buffer[ix] - input.params.zero_point) * input.params.scale);
+            ei_printf(" ");
+        }
+        ei_printf("\n");
+    }
+
+    ctx_start_us = ei_read_timer_us();
+
+    EI_IMPULSE_ERROR run_res = inference_tflite_run(
+        impulse,
+        block_config,
+        ctx_start_us,
+        &output,
+        &output_labels,
+        &output_scores,
+        static_cast<uint8_t*>(p_tensor_arena.get()),
+        result,
+        debug);
+
+    graph_config->model_reset(ei_aligned_free);
+
+    if (run_res != EI_IMPULSE_OK) {
+        return run_res;
+    }
+
+    return EI_IMPULSE_OK;
+}
 #endif // EI_CLASSIFIER_QUANTIZATION_ENABLED == 1
 
 __attribute__((unused)) int extract_tflite_eon_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
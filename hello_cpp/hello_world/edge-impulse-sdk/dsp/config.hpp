@@ -102,5 +102,31 @@
 #define EIDSP_SIGNAL_C_FN_POINTER    0
 #endif // EIDSP_SIGNAL_C_FN_POINTER
 
+// number of FFT lengths numpy::rfft keeps a plan (twiddles + scratch) for, 0 to disable
+#ifndef EIDSP_RFFT_PLAN_CACHE_SIZE
+#define EIDSP_RFFT_PLAN_CACHE_SIZE   4
+#endif // EIDSP_RFFT_PLAN_CACHE_SIZE
+
+// number of Butterworth designs (sampling frequency, cutoff, order, type) kept as second order sections
+#ifndef EIDSP_BUTTERWORTH_SOS_CACHE_SIZE
+#define EIDSP_BUTTERWORTH_SOS_CACHE_SIZE   2
+#endif // EIDSP_BUTTERWORTH_SOS_CACHE_SIZE
+
+// matrix buffers (EI_DSP_MATRIX and friends) come from a static scratch arena instead of ei_calloc
+#ifndef EIDSP_USE_SCRATCH_ARENA
+#define EIDSP_USE_SCRATCH_ARENA      0
+#endif // EIDSP_USE_SCRATCH_ARENA
+
+// arena size in bytes, ei_dsp_scratch_report() prints what a run needed
+// define EIDSP_SCRATCH_ARENA_SECTION (e.g. ".noinit.ei_dsp_scratch") to place it with the linker
+#ifndef EIDSP_SCRATCH_ARENA_SIZE
+#define EIDSP_SCRATCH_ARENA_SIZE     4096
+#endif // EIDSP_SCRATCH_ARENA_SIZE
+
+// spectral analysis (FFT, v1) in q31 instead of float, for targets without an FPU
+#ifndef EIDSP_USE_FIXED_POINT_SPECTRAL
+#define EIDSP_USE_FIXED_POINT_SPECTRAL   0
+#endif // EIDSP_USE_FIXED_POINT_SPECTRAL
+
 // clang-format on
 #endif // _EIDSP_CPP_CONFIG_H_
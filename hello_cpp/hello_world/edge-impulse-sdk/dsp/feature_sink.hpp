@@ -0,0 +1,58 @@
+/*
+ * Where a DSP block writes its features.
+ *
+ * Normally that is a float matrix, which the inferencing engine later quantizes into the
+ * model's input tensor. For int8 models a block can instead quantize on write, straight into
+ * the input tensor: no float feature buffer and no separate copy + quantize pass. Rounding and
+ * clipping are the same as pre_cast_quantize, so the tensor ends up identical.
+ */
+#ifndef _EIDSP_FEATURE_SINK_H_
+#define _EIDSP_FEATURE_SINK_H_
+
+#include <math.h>
+#include <stdint.h>
+#include "numpy_types.h"
+
+namespace ei {
+
+typedef struct ei_feature_sink {
+    float *f32;             // float destination, or NULL
+    int8_t *i8;             // quantized destination, or NULL
+    size_t size;            // number of features
+    float scale;
+    int32_t zero_point;
+
+    ei_feature_sink(matrix_t *matrix)
+        : f32(matrix->buffer), i8(NULL), size(matrix->rows * matrix->cols), scale(1.0f), zero_point(0)
+    {
+    }
+
+    ei_feature_sink(matrix_i8_t *matrix, float scale, int32_t zero_point)
+        : f32(NULL), i8(matrix->buffer), size(matrix->rows * matrix->cols), scale(scale), zero_point(zero_point)
+    {
+    }
+
+    void write(size_t ix, float value)
+    {
+        if (f32) {
+            f32[ix] = value;
+            return;
+        }
+
+        int32_t q = static_cast<int32_t>(round(value / scale)) + zero_point;
+        q = q < -128 ? -128 : (q > 127 ? 127 : q);
+        i8[ix] = static_cast<int8_t>(q);
+    }
+
+    /**
+     * Feature ix as the model sees it (dequantized for int8 sinks)
+     */
+    float read(size_t ix) const
+    {
+        return f32 ? f32[ix] : (i8[ix] - zero_point) * scale;
+    }
+} feature_sink_t;
+
+} // namespace ei
+
+#endif // _EIDSP_FEATURE_SINK_H_
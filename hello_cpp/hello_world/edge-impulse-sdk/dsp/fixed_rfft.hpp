@@ -0,0 +1,350 @@
+/*
+ * Fixed-length real FFTs for the small power-of-two sizes spectral blocks use (16 - 256).
+ *
+ * Everything about the transform is known at compile time: the complex FFT of N/2 points is a
+ * template recursion (radix-2 decimation in time down to a radix-4 leaf) with constant strides,
+ * and the twiddles are constexpr tables, so they end up in flash and the compiler can unroll
+ * the butterflies. There is no plan, no factorization and no indirect call. Output matches
+ * kiss_fftr: X[k] = sum x[n] e^(-2 pi i k n / N), k = 0 .. N/2, unnormalized.
+ */
+#ifndef _EIDSP_FIXED_RFFT_H_
+#define _EIDSP_FIXED_RFFT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "numpy_types.h"
+#include "returntypes.hpp"
+
+// constexpr tables need C++14 loops
+#if !defined(EIDSP_USE_FIXED_RFFT)
+#if __cplusplus >= 201402L
+#define EIDSP_USE_FIXED_RFFT        1
+#else
+#define EIDSP_USE_FIXED_RFFT        0
+#endif
+#endif // EIDSP_USE_FIXED_RFFT
+
+#if EIDSP_USE_FIXED_RFFT
+
+namespace ei {
+namespace fixed_fft {
+
+/**
+ * sin(x) for x in [-pi, pi] as a constexpr Taylor series, good to double precision
+ */
+constexpr double constexpr_sin(double x)
+{
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 15; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexpr_cos(double x)
+{
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 15; n++) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * W_N^k = e^(-2 pi i k / N) for k < N / 2
+ */
+template <size_t N>
+struct twiddle_table {
+    float r[N / 2];
+    float i[N / 2];
+
+    constexpr twiddle_table() : r(), i()
+    {
+        for (size_t k = 0; k < N / 2; k++) {
+            // angle in (-pi, 0], inside the series' range
+            const double a = -2.0 * 3.14159265358979323846 * static_cast<double>(k) / N;
+            r[k] = static_cast<float>(constexpr_cos(a));
+            i[k] = static_cast<float>(constexpr_sin(a));
+        }
+    }
+};
+
+template <size_t N>
+struct twiddles {
+    static constexpr twiddle_table<N> table {};
+};
+
+template <size_t N>
+constexpr twiddle_table<N> twiddles<N>::table;
+
+/**
+ * Complex FFT of M points read from interleaved (re, im) floats at element stride S,
+ * written in order to out. Twiddles come from the N point table at stride N / M.
+ */
+template <size_t N, size_t M, size_t S>
+struct cfft {
+    static inline void run(const float *in, fft_complex_t *out)
+    {
+        constexpr size_t half = M / 2;
+        constexpr size_t tw_stride = N / M;
+
+        cfft<N, half, 2 * S>::run(in, out);
+        cfft<N, half, 2 * S>::run(in + 2 * S, out + half);
+
+        for (size_t k = 0; k < half; k++) {
+            const float wr = twiddles<N>::table.r[k * tw_stride];
+            const float wi = twiddles<N>::table.i[k * tw_stride];
+            const fft_complex_t b = out[k + half];
+            const float tr = b.r * wr - b.i * wi;
+            const float ti = b.r * wi + b.i * wr;
+
+            out[k + half].r = out[k].r - tr;
+            out[k + half].i = out[k].i - ti;
+            out[k].r += tr;
+            out[k].i += ti;
+        }
+    }
+};
+
+// radix-4 leaf
+template <size_t N, size_t S>
+struct cfft<N, 4, S> {
+    static inline void run(const float *in, fft_complex_t *out)
+    {
+        const float ar = in[0],         ai = in[1];
+        const float br = in[2 * S],     bi = in[2 * S + 1];
+        const float cr = in[4 * S],     ci = in[4 * S + 1];
+        const float dr = in[6 * S],     di = in[6 * S + 1];
+
+        const float s0r = ar + cr, s0i = ai + ci;
+        const float d0r = ar - cr, d0i = ai - ci;
+        const float s1r = br + dr, s1i = bi + di;
+        const float d1r = br - dr, d1i = bi - di;
+
+        out[0].r = s0r + s1r;   out[0].i = s0i + s1i;
+        out[1].r = d0r + d1i;   out[1].i = d0i - d1r;   // (a - c) - i (b - d)
+        out[2].r = s0r - s1r;   out[2].i = s0i - s1i;
+        out[3].r = d0r - d1i;   out[3].i = d0i + d1r;   // (a - c) + i (b - d)
+    }
+};
+
+/**
+ * Real FFT of N points: the N / 2 point complex FFT of the even / odd samples packed as
+ * (re, im), then the usual split into N / 2 + 1 bins, done in place in the output.
+ */
+template <size_t N>
+static inline void rfft(const float *input, fft_complex_t *output)
+{
+    constexpr size_t M = N / 2;
+
+    cfft<N, M, 1>::run(input, output);
+
+    const fft_complex_t z0 = output[0];
+    output[0].r = z0.r + z0.i;
+    output[0].i = 0.0f;
+    output[M].r = z0.r - z0.i;
+    output[M].i = 0.0f;
+
+    // bins k and M - k only depend on Z[k] and Z[M - k], so do them as a pair
+    for (size_t k = 1; k <= M / 2; k++) {
+        const fft_complex_t zk = output[k];
+        const fft_complex_t zm = output[M - k];
+
+        // X[k] = (Z[k] + conj(Z[M-k])) / 2 - i/2 W^k (Z[k] - conj(Z[M-k]))
+        const float er = 0.5f * (zk.r + zm.r), ei = 0.5f * (zk.i - zm.i);
+        const float or_ = 0.5f * (zk.i + zm.i), oi = -0.5f * (zk.r - zm.r);
+
+        const float wr = twiddles<N>::table.r[k], wi = twiddles<N>::table.i[k];
+        output[k].r = er + (or_ * wr - oi * wi);
+        output[k].i = ei + (or_ * wi + oi * wr);
+
+        if (k != M - k) {
+            // same with the roles swapped, W^(M-k) = -conj(W^k)
+            const float er2 = er, ei2 = -ei;
+            const float or2 = or_, oi2 = -oi;
+            const float wr2 = -wr, wi2 = wi;
+            output[M - k].r = er2 + (or2 * wr2 - oi2 * wi2);
+            output[M - k].i = ei2 + (or2 * wi2 + oi2 * wr2);
+        }
+    }
+}
+
+/**
+ * Run the fixed kernel for n_fft if there is one
+ * @returns EIDSP_OK, or EIDSP_FFT_SIZE_NOT_SUPPORTED for other lengths
+ */
+static inline int run_rfft(const float *input, fft_complex_t *output, size_t n_fft)
+{
+    switch (n_fft) {
+        case 16: rfft<16>(input, output); return EIDSP_OK;
+        case 32: rfft<32>(input, output); return EIDSP_OK;
+        case 64: rfft<64>(input, output); return EIDSP_OK;
+        case 128: rfft<128>(input, output); return EIDSP_OK;
+        case 256: rfft<256>(input, output); return EIDSP_OK;
+        default: return EIDSP_FFT_SIZE_NOT_SUPPORTED;
+    }
+}
+
+/**
+ * Same transforms in q31, for the fixed-point spectral path. Every stage halves, so the
+ * output is X[k] / N: same scaling as CMSIS arm_rfft_q31, and no overflow as long as the
+ * input stays below 2^30 in magnitude. Bins are interleaved (r, i), N / 2 + 1 of them.
+ */
+constexpr int32_t q31_from_double(double v)
+{
+    return v * 2147483648.0 >= 2147483647.0 ? INT32_MAX :
+        v * 2147483648.0 <= -2147483648.0 ? INT32_MIN :
+        static_cast<int32_t>(v * 2147483648.0 + (v >= 0 ? 0.5 : -0.5));
+}
+
+template <size_t N>
+struct twiddle_table_q31 {
+    int32_t r[N / 2];
+    int32_t i[N / 2];
+
+    constexpr twiddle_table_q31() : r(), i()
+    {
+        for (size_t k = 0; k < N / 2; k++) {
+            const double a = -2.0 * 3.14159265358979323846 * static_cast<double>(k) / N;
+            r[k] = q31_from_double(constexpr_cos(a));
+            i[k] = q31_from_double(constexpr_sin(a));
+        }
+    }
+};
+
+template <size_t N>
+struct twiddles_q31 {
+    static constexpr twiddle_table_q31<N> table {};
+};
+
+template <size_t N>
+constexpr twiddle_table_q31<N> twiddles_q31<N>::table;
+
+// (a * b) / 2^31 for complex b with |b| <= 1, real part and imaginary part
+static inline int32_t cmul_r_q31(int32_t ar, int32_t ai, int32_t br, int32_t bi)
+{
+    return static_cast<int32_t>(((int64_t)ar * br - (int64_t)ai * bi + (1LL << 30)) >> 31);
+}
+
+static inline int32_t cmul_i_q31(int32_t ar, int32_t ai, int32_t br, int32_t bi)
+{
+    return static_cast<int32_t>(((int64_t)ar * bi + (int64_t)ai * br + (1LL << 30)) >> 31);
+}
+
+static inline int32_t half_sum_q31(int32_t a, int32_t b)
+{
+    return static_cast<int32_t>(((int64_t)a + b + 1) >> 1);
+}
+
+/**
+ * Complex FFT of M points, divided by M, see cfft for the layout
+ */
+template <size_t N, size_t M, size_t S>
+struct cfft_q31 {
+    static inline void run(const int32_t *in, int32_t *out)
+    {
+        constexpr size_t half = M / 2;
+        constexpr size_t tw_stride = N / M;
+
+        cfft_q31<N, half, 2 * S>::run(in, out);
+        cfft_q31<N, half, 2 * S>::run(in + 2 * S, out + 2 * half);
+
+        for (size_t k = 0; k < half; k++) {
+            const int32_t wr = twiddles_q31<N>::table.r[k * tw_stride];
+            const int32_t wi = twiddles_q31<N>::table.i[k * tw_stride];
+            int32_t *a = out + 2 * k;
+            int32_t *b = out + 2 * (k + half);
+            const int32_t tr = cmul_r_q31(b[0], b[1], wr, wi);
+            const int32_t ti = cmul_i_q31(b[0], b[1], wr, wi);
+
+            b[0] = half_sum_q31(a[0], -tr);
+            b[1] = half_sum_q31(a[1], -ti);
+            a[0] = half_sum_q31(a[0], tr);
+            a[1] = half_sum_q31(a[1], ti);
+        }
+    }
+};
+
+template <size_t N, size_t S>
+struct cfft_q31<N, 4, S> {
+    static inline void run(const int32_t *in, int32_t *out)
+    {
+        const int64_t ar = in[0],         ai = in[1];
+        const int64_t br = in[2 * S],     bi = in[2 * S + 1];
+        const int64_t cr = in[4 * S],     ci = in[4 * S + 1];
+        const int64_t dr = in[6 * S],     di = in[6 * S + 1];
+
+        const int64_t s0r = ar + cr, s0i = ai + ci;
+        const int64_t d0r = ar - cr, d0i = ai - ci;
+        const int64_t s1r = br + dr, s1i = bi + di;
+        const int64_t d1r = br - dr, d1i = bi - di;
+
+        out[0] = static_cast<int32_t>((s0r + s1r + 2) >> 2);  out[1] = static_cast<int32_t>((s0i + s1i + 2) >> 2);
+        out[2] = static_cast<int32_t>((d0r + d1i + 2) >> 2);  out[3] = static_cast<int32_t>((d0i - d1r + 2) >> 2);
+        out[4] = static_cast<int32_t>((s0r - s1r + 2) >> 2);  out[5] = static_cast<int32_t>((s0i - s1i + 2) >> 2);
+        out[6] = static_cast<int32_t>((d0r - d1i + 2) >> 2);  out[7] = static_cast<int32_t>((d0i + d1r + 2) >> 2);
+    }
+};
+
+/**
+ * Real FFT of N q31 points into N / 2 + 1 interleaved bins, X[k] / N
+ */
+template <size_t N>
+static inline void rfft_q31(const int32_t *input, int32_t *output)
+{
+    constexpr size_t M = N / 2;
+
+    cfft_q31<N, M, 1>::run(input, output);
+
+    const int32_t z0r = output[0], z0i = output[1];
+    output[0] = half_sum_q31(z0r, z0i);
+    output[1] = 0;
+    output[2 * M] = half_sum_q31(z0r, -z0i);
+    output[2 * M + 1] = 0;
+
+    for (size_t k = 1; k <= M / 2; k++) {
+        const int32_t zkr = output[2 * k], zki = output[2 * k + 1];
+        const int32_t zmr = output[2 * (M - k)], zmi = output[2 * (M - k) + 1];
+
+        // X[k] / N = (E + W^k O) / 2, with E and O as in rfft (already divided by M)
+        const int32_t er = half_sum_q31(zkr, zmr), ei = half_sum_q31(zki, -zmi);
+        const int32_t or_ = half_sum_q31(zki, zmi), oi = half_sum_q31(zmr, -zkr);
+
+        const int32_t wr = twiddles_q31<N>::table.r[k], wi = twiddles_q31<N>::table.i[k];
+        const int32_t tr = cmul_r_q31(or_, oi, wr, wi);
+        const int32_t ti = cmul_i_q31(or_, oi, wr, wi);
+        output[2 * k] = half_sum_q31(er, tr);
+        output[2 * k + 1] = half_sum_q31(ei, ti);
+
+        if (k != M - k) {
+            // W^(M-k) = -conj(W^k), E and O conjugated
+            const int32_t tr2 = cmul_r_q31(or_, -oi, -wr, wi);
+            const int32_t ti2 = cmul_i_q31(or_, -oi, -wr, wi);
+            output[2 * (M - k)] = half_sum_q31(er, tr2);
+            output[2 * (M - k) + 1] = half_sum_q31(-ei, ti2);
+        }
+    }
+}
+
+static inline int run_rfft_q31(const int32_t *input, int32_t *output, size_t n_fft)
+{
+    switch (n_fft) {
+        case 16: rfft_q31<16>(input, output); return EIDSP_OK;
+        case 32: rfft_q31<32>(input, output); return EIDSP_OK;
+        case 64: rfft_q31<64>(input, output); return EIDSP_OK;
+        case 128: rfft_q31<128>(input, output); return EIDSP_OK;
+        case 256: rfft_q31<256>(input, output); return EIDSP_OK;
+        default: return EIDSP_FFT_SIZE_NOT_SUPPORTED;
+    }
+}
+
+} // namespace fixed_fft
+} // namespace ei
+
+#endif // EIDSP_USE_FIXED_RFFT
+
+#endif // _EIDSP_FIXED_RFFT_H_
@@ -32,3 +32,103 @@
 
 size_t ei_memory_in_use = 0;
 size_t ei_memory_peak_use = 0;
+
+#if EIDSP_USE_SCRATCH_ARENA
+
+#include <string.h>
+
+#define EIDSP_SCRATCH_ALIGN         8
+#define EIDSP_SCRATCH_NO_BLOCK      0xffffffffUL
+
+typedef struct {
+    uint32_t prev;      // offset of the block below, EIDSP_SCRATCH_NO_BLOCK for the first one
+    uint32_t size;      // bytes including this header, 0 once freed
+} ei_dsp_scratch_header_t;
+
+#if defined(EIDSP_SCRATCH_ARENA_SECTION)
+__attribute__((section(EIDSP_SCRATCH_ARENA_SECTION)))
+#endif
+static uint8_t ei_dsp_scratch[EIDSP_SCRATCH_ARENA_SIZE] __attribute__((aligned(EIDSP_SCRATCH_ALIGN)));
+static size_t ei_dsp_scratch_top = 0;
+static uint32_t ei_dsp_scratch_last = EIDSP_SCRATCH_NO_BLOCK;
+static size_t ei_dsp_scratch_in_use = 0;        // arena and heap fallback
+static size_t ei_dsp_scratch_peak_use = 0;
+static size_t ei_dsp_scratch_fallbacks = 0;
+
+void *ei_dsp_scratch_calloc(size_t num, size_t size)
+{
+    const size_t bytes = (sizeof(ei_dsp_scratch_header_t) + num * size + EIDSP_SCRATCH_ALIGN - 1) &
+        ~(size_t)(EIDSP_SCRATCH_ALIGN - 1);
+    ei_dsp_scratch_header_t *h;
+
+    if (ei_dsp_scratch_top + bytes <= EIDSP_SCRATCH_ARENA_SIZE) {
+        h = (ei_dsp_scratch_header_t *)&ei_dsp_scratch[ei_dsp_scratch_top];
+        h->prev = ei_dsp_scratch_last;
+        h->size = bytes;
+        ei_dsp_scratch_last = ei_dsp_scratch_top;
+        ei_dsp_scratch_top += bytes;
+        memset(h + 1, 0, bytes - sizeof(ei_dsp_scratch_header_t));
+    }
+    else {
+        h = (ei_dsp_scratch_header_t *)ei_calloc(bytes, 1);
+        if (!h) {
+            return NULL;
+        }
+        h->prev = EIDSP_SCRATCH_NO_BLOCK;
+        h->size = bytes;
+        if (ei_dsp_scratch_fallbacks++ == 0) {
+            ei_printf("WARN: DSP scratch arena full (%u bytes), falling back to the heap\n",
+                (unsigned)EIDSP_SCRATCH_ARENA_SIZE);
+        }
+    }
+
+    ei_dsp_scratch_in_use += bytes;
+    if (ei_dsp_scratch_in_use > ei_dsp_scratch_peak_use) {
+        ei_dsp_scratch_peak_use = ei_dsp_scratch_in_use;
+    }
+    return h + 1;
+}
+
+void ei_dsp_scratch_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    ei_dsp_scratch_header_t *h = (ei_dsp_scratch_header_t *)ptr - 1;
+
+    ei_dsp_scratch_in_use -= h->size;
+    if ((uint8_t *)h < ei_dsp_scratch || (uint8_t *)h >= ei_dsp_scratch + EIDSP_SCRATCH_ARENA_SIZE) {
+        ei_free(h);
+        return;
+    }
+
+    // blocks freed out of order stay until everything above them is gone too
+    h->size = 0;
+    while (ei_dsp_scratch_last != EIDSP_SCRATCH_NO_BLOCK) {
+        ei_dsp_scratch_header_t *last = (ei_dsp_scratch_header_t *)&ei_dsp_scratch[ei_dsp_scratch_last];
+        if (last->size != 0) {
+            break;
+        }
+        ei_dsp_scratch_top = ei_dsp_scratch_last;
+        ei_dsp_scratch_last = last->prev;
+    }
+}
+
+size_t ei_dsp_scratch_peak()
+{
+    return ei_dsp_scratch_peak_use;
+}
+
+void ei_dsp_scratch_report()
+{
+    ei_printf("DSP scratch arena: peak %u of %u bytes",
+        (unsigned)ei_dsp_scratch_peak_use, (unsigned)EIDSP_SCRATCH_ARENA_SIZE);
+    if (ei_dsp_scratch_fallbacks > 0) {
+        ei_printf(", %u allocations went to the heap, set EIDSP_SCRATCH_ARENA_SIZE to at least %u",
+            (unsigned)ei_dsp_scratch_fallbacks, (unsigned)ei_dsp_scratch_peak_use);
+    }
+    ei_printf("\n");
+}
+
+#endif // EIDSP_USE_SCRATCH_ARENA
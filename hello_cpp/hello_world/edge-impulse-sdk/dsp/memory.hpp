@@ -42,6 +42,26 @@
 extern size_t ei_memory_in_use;
 extern size_t ei_memory_peak_use;
 
+#if EIDSP_USE_SCRATCH_ARENA
+/**
+ * Scratch arena for matrix buffers (see memory.cpp). Blocks are handed out like a stack and
+ * released as soon as everything above them is released, which is what scoped matrices do;
+ * a full arena falls back to ei_calloc.
+ */
+void *ei_dsp_scratch_calloc(size_t num, size_t size);
+void ei_dsp_scratch_free(void *ptr);
+/** Most bytes (arena and heap fallback, with block headers) in use at once so far */
+size_t ei_dsp_scratch_peak();
+/** Prints the peak and, if the arena was too small, the EIDSP_SCRATCH_ARENA_SIZE it needs */
+void ei_dsp_scratch_report();
+
+#define ei_dsp_matrix_calloc    ei_dsp_scratch_calloc
+#define ei_dsp_matrix_free      ei_dsp_scratch_free
+#else
+#define ei_dsp_matrix_calloc    ei_calloc
+#define ei_dsp_matrix_free      ei_free
+#endif // EIDSP_USE_SCRATCH_ARENA
+
 #if EIDSP_PRINT_ALLOCATIONS == 1
 #define ei_dsp_printf           printf
 #else
@@ -38,6 +38,7 @@
 #include "ei_utils.h"
 #include "dct/fast-dct-fft.h"
 #include "kissfft/kiss_fftr.h"
+#include "fixed_rfft.hpp"
 #include "edge-impulse-sdk/porting/ei_logging.h"
 
 #if __has_include("model-parameters/model_metadata.h")
@@ -1273,6 +1274,124 @@ public:
     }
 
 
+    /**
+     * Mean and central moment sums of a signal, see moments()
+     */
+    typedef struct {
+        float mean;
+        float m2;   // sum of (x - mean)^2
+        float m3;   // sum of (x - mean)^3
+        float m4;   // sum of (x - mean)^4
+    } moments_t;
+
+    /**
+     * Mean and the 2nd to 4th central moment sums in a single pass over the signal, instead of
+     * one pass for the mean and more for each moment (as mean, stdev, skew and kurtosis do).
+     * Power sums are taken around the first sample and shifted to the mean afterwards, which
+     * keeps them from cancelling on signals with a large offset (e.g. gravity).
+     * @param input Signal
+     * @param input_size Number of samples, at least 1
+     * @param out Moments
+     */
+    static void moments(const float *input, size_t input_size, moments_t *out)
+    {
+        const float shift = input[0];
+        float s1 = 0.0f, s2 = 0.0f, s3 = 0.0f, s4 = 0.0f;
+
+        for (size_t ix = 0; ix < input_size; ix++) {
+            const float d = input[ix] - shift;
+            const float d2 = d * d;
+            s1 += d;
+            s2 += d2;
+            s3 += d2 * d;
+            s4 += d2 * d2;
+        }
+
+        const float n = static_cast<float>(input_size);
+        const float mu = s1 / n;
+        const float mu2 = mu * mu;
+
+        out->mean = shift + mu;
+        out->m2 = s2 - n * mu2;
+        out->m3 = s3 - 3.0f * mu * s2 + 2.0f * n * mu2 * mu;
+        out->m4 = s4 - 4.0f * mu * s3 + 6.0f * mu2 * s2 - 3.0f * n * mu2 * mu2;
+        if (out->m2 < 0.0f) {
+            out->m2 = 0.0f;
+        }
+    }
+
+    /**
+     * Everything rfft needs for one FFT length, kept across calls: the kissfft state
+     * (twiddles), a zero padded input buffer and a complex output buffer. With a plan the
+     * transform itself does not touch the heap; plans are created on first use of a length
+     * and live until clear_rfft_plans(). Not thread safe, like the rest of the DSP code.
+     */
+    typedef struct {
+        size_t n_fft;
+        kiss_fftr_cfg cfg;        // created on the first software transform
+        float *input;             // n_fft
+        fft_complex_t *output;    // n_fft / 2 + 1
+    } rfft_plan_t;
+
+    static rfft_plan_t *rfft_plans()
+    {
+        static rfft_plan_t plans[EIDSP_RFFT_PLAN_CACHE_SIZE > 0 ? EIDSP_RFFT_PLAN_CACHE_SIZE : 1] = { };
+        return plans;
+    }
+
+    /**
+     * Plan for n_fft, creating it if there is room.
+     * @returns the plan, or NULL if the cache is full or out of memory (callers then
+     *  allocate per call as before)
+     */
+    static rfft_plan_t *get_rfft_plan(size_t n_fft)
+    {
+        rfft_plan_t *plans = rfft_plans();
+
+        for (size_t ix = 0; ix < EIDSP_RFFT_PLAN_CACHE_SIZE; ix++) {
+            if (plans[ix].n_fft == n_fft) {
+                return &plans[ix];
+            }
+        }
+        for (size_t ix = 0; ix < EIDSP_RFFT_PLAN_CACHE_SIZE; ix++) {
+            if (plans[ix].n_fft == 0) {
+                plans[ix].input = (float *)ei_calloc(n_fft, sizeof(float));
+                plans[ix].output = (fft_complex_t *)ei_calloc(n_fft / 2 + 1, sizeof(fft_complex_t));
+                if (!plans[ix].input || !plans[ix].output) {
+                    ei_free(plans[ix].input);
+                    ei_free(plans[ix].output);
+                    plans[ix].input = NULL;
+                    plans[ix].output = NULL;
+                    return NULL;
+                }
+                plans[ix].n_fft = n_fft;
+                plans[ix].cfg = NULL;
+                return &plans[ix];
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * Free all cached rfft plans
+     */
+    static void clear_rfft_plans()
+    {
+        rfft_plan_t *plans = rfft_plans();
+
+        for (size_t ix = 0; ix < EIDSP_RFFT_PLAN_CACHE_SIZE; ix++) {
+            if (plans[ix].n_fft == 0) {
+                continue;
+            }
+            if (plans[ix].cfg) {
+                kiss_fftr_free(plans[ix].cfg);
+            }
+            ei_free(plans[ix].input);
+            ei_free(plans[ix].output);
+            memset(&plans[ix], 0, sizeof(rfft_plan_t));
+        }
+    }
+
     /**
      * Compute the one-dimensional discrete Fourier Transform for real input.
      * This function computes the one-dimensional n-point discrete Fourier Transform (DFT) of
@@ -1290,8 +1409,15 @@ public:
         }
 
         fft_complex_t *fft_output = NULL;
-        auto ptr = EI_MAKE_TRACKED_POINTER(fft_output, n_fft_out_features);
-        EI_ERR_AND_RETURN_ON_NULL(fft_output, EIDSP_OUT_OF_MEM);
+        rfft_plan_t *plan = get_rfft_plan(n_fft);
+        ei_unique_ptr_t ptr;
+        if (plan) {
+            fft_output = plan->output;
+        }
+        else {
+            ptr = EI_MAKE_TRACKED_POINTER(fft_output, n_fft_out_features);
+            EI_ERR_AND_RETURN_ON_NULL(fft_output, EIDSP_OUT_OF_MEM);
+        }
 
         int ret = rfft(src, src_size, fft_output, n_fft_out_features, n_fft);
         if (ret != EIDSP_OK) {
@@ -1332,6 +1458,16 @@ public:
         if (src_size >= n_fft) { // technically they can only be equal or src < n_fft, b/c of step above
             fft_input_buffer = (float*)src;
         } // else we need to copy over and pad
+        else {
+            // pad in the plan's buffer if there is one
+            rfft_plan_t *plan = get_rfft_plan(n_fft);
+            if (plan) {
+                memcpy(plan->input, src, src_size * sizeof(float));
+                memset(plan->input + src_size, 0, (n_fft - src_size) * sizeof(float));
+                fft_input_buffer = plan->input;
+                src_size = n_fft;
+            }
+        }
 
         // If fft_input_buffer is NULL (see above), then the constructor will allocate a new buffer
         EI_DSP_MATRIX_B(fft_input, 1, n_fft, fft_input_buffer);
@@ -1347,6 +1483,13 @@ public:
             memset(fft_input.buffer + src_size, 0, (n_fft - src_size) * sizeof(float));
         }
 
+#if EIDSP_USE_FIXED_RFFT
+        // compile time kernels for the small power of two lengths
+        if (ei::fixed_fft::run_rfft(fft_input.buffer, output, n_fft) == EIDSP_OK) {
+            return EIDSP_OK;
+        }
+#endif
+
         auto res = ei::fft::hw_r2c_fft(fft_input.buffer, output, n_fft);
         if (handle_fft_hw_failure(res, n_fft)) {
             // fallback to software
@@ -1722,7 +1865,18 @@ public:
     static int software_rfft(float *fft_input, fft_complex_t *output, size_t n_fft, size_t n_fft_out_features)
     {
     #if EIDSP_INCLUDE_KISSFFT || !defined(EIDSP_INCLUDE_KISSFFT)
-        // create fftr context
+        rfft_plan_t *plan = get_rfft_plan(n_fft);
+        if (plan) {
+            if (!plan->cfg) {
+                plan->cfg = kiss_fftr_alloc(n_fft, 0, NULL, NULL, NULL);
+            }
+            if (plan->cfg) {
+                kiss_fftr(plan->cfg, fft_input, (kiss_fft_cpx*)output);
+                return EIDSP_OK;
+            }
+        }
+
+        // no plan: create fftr context for this call only
         size_t kiss_fftr_mem_length;
 
         kiss_fftr_cfg cfg = kiss_fftr_alloc(n_fft, 0, NULL, NULL, &kiss_fftr_mem_length);
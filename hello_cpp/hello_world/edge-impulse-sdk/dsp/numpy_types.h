@@ -104,7 +104,7 @@ typedef struct ei_matrix {
             buffer_managed_by_me = false;
         }
         else {
-            buffer = (float*)ei_calloc(n_rows * n_cols * sizeof(float), 1);
+            buffer = (float*)ei_dsp_matrix_calloc(n_rows * n_cols * sizeof(float), 1);
             buffer_managed_by_me = true;
         }
         rows = n_rows;
@@ -129,7 +129,7 @@ typedef struct ei_matrix {
 
     ~ei_matrix() {
         if (buffer && buffer_managed_by_me) {
-            ei_free(buffer);
+            ei_dsp_matrix_free(buffer);
 
 #if EIDSP_TRACK_ALLOCATIONS
             if (_fn) {
@@ -203,7 +203,7 @@ typedef struct ei_matrix_i8 {
             buffer_managed_by_me = false;
         }
         else {
-            buffer = (int8_t*)ei_calloc(n_rows * n_cols * sizeof(int8_t), 1);
+            buffer = (int8_t*)ei_dsp_matrix_calloc(n_rows * n_cols * sizeof(int8_t), 1);
             buffer_managed_by_me = true;
         }
         rows = n_rows;
@@ -228,7 +228,7 @@ typedef struct ei_matrix_i8 {
 
     ~ei_matrix_i8() {
         if (buffer && buffer_managed_by_me) {
-            ei_free(buffer);
+            ei_dsp_matrix_free(buffer);
 
 #if EIDSP_TRACK_ALLOCATIONS
             if (_fn) {
@@ -299,7 +299,7 @@ typedef struct ei_matrix_i32 {
             buffer_managed_by_me = false;
         }
         else {
-            buffer = (int32_t*)ei_calloc(n_rows * n_cols * sizeof(int32_t), 1);
+            buffer = (int32_t*)ei_dsp_matrix_calloc(n_rows * n_cols * sizeof(int32_t), 1);
             buffer_managed_by_me = true;
         }
         rows = n_rows;
@@ -324,7 +324,7 @@ typedef struct ei_matrix_i32 {
 
     ~ei_matrix_i32() {
         if (buffer && buffer_managed_by_me) {
-            ei_free(buffer);
+            ei_dsp_matrix_free(buffer);
 
 #if EIDSP_TRACK_ALLOCATIONS
             if (_fn) {
@@ -406,7 +406,7 @@ typedef struct ei_quantized_matrix {
             buffer_managed_by_me = false;
         }
         else {
-            buffer = (uint8_t*)ei_calloc(n_rows * n_cols * sizeof(uint8_t), 1);
+            buffer = (uint8_t*)ei_dsp_matrix_calloc(n_rows * n_cols * sizeof(uint8_t), 1);
             buffer_managed_by_me = true;
         }
         rows = n_rows;
@@ -431,7 +431,7 @@ typedef struct ei_quantized_matrix {
 
     ~ei_quantized_matrix() {
         if (buffer && buffer_managed_by_me) {
-            ei_free(buffer);
+            ei_dsp_matrix_free(buffer);
 
 #if EIDSP_TRACK_ALLOCATIONS
             if (_fn) {
@@ -502,7 +502,7 @@ typedef struct ei_matrix_u8 {
             buffer_managed_by_me = false;
         }
         else {
-            buffer = (uint8_t*)ei_calloc(n_rows * n_cols * sizeof(uint8_t), 1);
+            buffer = (uint8_t*)ei_dsp_matrix_calloc(n_rows * n_cols * sizeof(uint8_t), 1);
             buffer_managed_by_me = true;
         }
         rows = n_rows;
@@ -527,7 +527,7 @@ typedef struct ei_matrix_u8 {
 
     ~ei_matrix_u8() {
         if (buffer && buffer_managed_by_me) {
-            ei_free(buffer);
+            ei_dsp_matrix_free(buffer);
 
 #if EIDSP_TRACK_ALLOCATIONS
             if (_fn) {
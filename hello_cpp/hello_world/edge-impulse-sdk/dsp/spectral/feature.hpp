@@ -35,6 +35,7 @@
 #include "processing.hpp"
 #include "wavelet.hpp"
 #include "signal.hpp"
+#include "../feature_sink.hpp"
 #include "edge-impulse-sdk/dsp/ei_utils.h"
 #include "model-parameters/model_metadata.h"
 
@@ -47,6 +48,31 @@ typedef enum {
     filter_highpass = 2
 } filter_t;
 
+/**
+ * One slice of one axis, as kept by sliced (continuous) spectral analysis.
+ * The moments are about the slice's own mean so that combining slices stays accurate
+ * for signals with a large offset (e.g. orientation angles).
+ */
+typedef struct {
+    uint32_t count;             // samples in the slice
+    float mean;                 // mean of the slice
+    float m2;                   // sum of squared deviations from that mean
+} spectral_slice_moments_t;
+
+/**
+ * State for feature::extract_spectral_analysis_features_v1_slice, one model window of
+ * slices per axis in a ring. Clear with feature::free_spectral_slice_state.
+ */
+typedef struct {
+    size_t axes;
+    uint16_t fft_length;
+    size_t slices_seen;
+    size_t next;                          // ring slot the next slice is written to
+    spectral_slice_moments_t *moments;    // [slot * axes + axis]
+    fft_complex_t *head_fft;              // FFT of the first fft_length samples, [(slot * axes + axis) * bins]
+    float *filter_state;                  // Butterworth state carried across slices, if the block filters
+} spectral_slice_state_t;
+
 class feature {
 public:
 
@@ -85,6 +111,32 @@ public:
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
         }
 
+        feature_sink_t sink(out_features);
+        return spectral_analysis(&sink, input_matrix, sampling_freq, filter_type, filter_cutoff,
+            filter_order, fft_length, fft_peaks, fft_peaks_threshold, edges_matrix_in);
+    }
+
+    /**
+     * Same as above, writing the features through a sink (e.g. quantized into the input tensor)
+     * @param out_features One row of `calculate_spectral_buffer_size` features per axis
+     */
+    static int spectral_analysis(
+        feature_sink_t *out_features,
+        matrix_t *input_matrix,
+        float sampling_freq,
+        filter_t filter_type,
+        float filter_cutoff,
+        uint8_t filter_order,
+        uint16_t fft_length,
+        uint8_t fft_peaks,
+        float fft_peaks_threshold,
+        matrix_t *edges_matrix_in
+    ) {
+        const size_t out_cols = calculate_spectral_buffer_size(true, fft_peaks, edges_matrix_in->rows);
+        if (out_features->size != input_matrix->rows * out_cols) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
         if (edges_matrix_in->cols != 1) {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
         }
@@ -93,7 +145,24 @@ public:
 
         size_t axes = input_matrix->rows;
 
-        EI_TRY(processing::subtract_mean(input_matrix) );
+        EI_DSP_MATRIX(rms_matrix, axes, 1);
+
+        if (filter_type == filter_none) {
+            // mean and RMS of the mean removed signal from the same pass
+            for (size_t row = 0; row < axes; row++) {
+                float *x = input_matrix->get_row_ptr(row);
+                numpy::moments_t m;
+
+                numpy::moments(x, input_matrix->cols, &m);
+                for (size_t ix = 0; ix < input_matrix->cols; ix++) {
+                    x[ix] -= m.mean;
+                }
+                rms_matrix.buffer[row] = sqrt(m.m2 / input_matrix->cols);
+            }
+        }
+        else {
+            EI_TRY(processing::subtract_mean(input_matrix) );
+        }
 
         // apply filter
         if (filter_type == filter_lowpass) {
@@ -112,10 +181,11 @@ public:
         }
 
         // calculate RMS
-        EI_DSP_MATRIX(rms_matrix, axes, 1);
-        ret = numpy::rms(input_matrix, &rms_matrix);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        if (filter_type != filter_none) {
+            ret = numpy::rms(input_matrix, &rms_matrix);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+            }
         }
 
         // find peaks in FFT
@@ -165,17 +235,17 @@ public:
                 EIDSP_ERR(ret);
             }
 
-            float *features_row = out_features->buffer + (row * out_features->cols);
+            const size_t features_row = row * out_cols;
 
             size_t fx = 0;
 
-            features_row[fx++] = rms_matrix.buffer[row];
+            out_features->write(features_row + fx++, rms_matrix.buffer[row]);
             for (size_t peak_row = 0; peak_row < peaks_matrix.rows; peak_row++) {
-                features_row[fx++] = peaks_matrix.buffer[peak_row * peaks_matrix.cols + 0];
-                features_row[fx++] = peaks_matrix.buffer[peak_row * peaks_matrix.cols + 1];
+                out_features->write(features_row + fx++, peaks_matrix.buffer[peak_row * peaks_matrix.cols + 0]);
+                out_features->write(features_row + fx++, peaks_matrix.buffer[peak_row * peaks_matrix.cols + 1]);
             }
             for (size_t edge_row = 0; edge_row < edges_matrix_out.rows; edge_row++) {
-                features_row[fx++] = edges_matrix_out.buffer[edge_row * edges_matrix_out.cols] / 10.0f;
+                out_features->write(features_row + fx++, edges_matrix_out.buffer[edge_row * edges_matrix_out.cols] / 10.0f);
             }
         }
 
@@ -201,38 +271,24 @@ public:
         return count;
     }
 
-    static int extract_spectral_analysis_features_v1(
-        matrix_t *input_matrix,
-        matrix_t *output_matrix,
-        ei_dsp_config_spectral_analysis_t *config_ptr,
-        const float sampling_freq)
+    /**
+     * Parse the spectral power edges ("0.1, 0.5, 1.0") into a column matrix.
+     * @param spectral_power_edges Comma separated edges
+     * @param edges_matrix Output matrix, rows are set to the number of edges found
+     * @returns 0 if OK
+     */
+    static int parse_spectral_power_edges(const char *spectral_power_edges, matrix_t *edges_matrix)
     {
-        // scale the signal
-        int ret = numpy::scale(input_matrix, config_ptr->scale_axes);
-        if (ret != EIDSP_OK) {
-            ei_printf("ERR: Failed to scale signal (%d)\n", ret);
-            EIDSP_ERR(ret);
-        }
-
-        // transpose the matrix so we have one row per axis (nifty!)
-        ret = numpy::transpose(input_matrix);
-        if (ret != EIDSP_OK) {
-            ei_printf("ERR: Failed to transpose matrix (%d)\n", ret);
-            EIDSP_ERR(ret);
-        }
-
-        // the spectral edges that we want to calculate
-        matrix_t edges_matrix_in(64, 1);
         size_t edge_matrix_ix = 0;
 
         char spectral_str[128] = { 0 };
-        if (strlen(config_ptr->spectral_power_edges) > sizeof(spectral_str) - 1) {
+        if (strlen(spectral_power_edges) > sizeof(spectral_str) - 1) {
             EIDSP_ERR(EIDSP_PARAMETER_INVALID);
         }
         memcpy(
             spectral_str,
-            config_ptr->spectral_power_edges,
-            strlen(config_ptr->spectral_power_edges));
+            spectral_power_edges,
+            strlen(spectral_power_edges));
 
         // convert spectral_power_edges (string) into float array
         char *spectral_ptr = spectral_str;
@@ -241,7 +297,10 @@ public:
                 spectral_ptr++;
             }
 
-            edges_matrix_in.buffer[edge_matrix_ix++] = atof(spectral_ptr);
+            if (edge_matrix_ix >= edges_matrix->rows) {
+                EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+            }
+            edges_matrix->buffer[edge_matrix_ix++] = atof(spectral_ptr);
 
             // find next (spectral) delimiter (or '\0' character)
             while ((*spectral_ptr != ',')) {
@@ -257,7 +316,54 @@ public:
                 spectral_ptr++;
             }
         }
-        edges_matrix_in.rows = edge_matrix_ix;
+        edges_matrix->rows = edge_matrix_ix;
+
+        return EIDSP_OK;
+    }
+
+    static int extract_spectral_analysis_features_v1(
+        matrix_t *input_matrix,
+        matrix_t *output_matrix,
+        ei_dsp_config_spectral_analysis_t *config_ptr,
+        const float sampling_freq)
+    {
+        feature_sink_t sink(output_matrix);
+        EI_TRY(extract_spectral_analysis_features_v1(input_matrix, &sink, config_ptr, sampling_freq));
+
+        // flat, one row of features per axis
+        output_matrix->cols = output_matrix->rows * output_matrix->cols;
+        output_matrix->rows = 1;
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * extract_spectral_analysis_features_v1 writing through a sink, e.g. quantize on write
+     * into an int8 input tensor
+     */
+    static int extract_spectral_analysis_features_v1(
+        matrix_t *input_matrix,
+        feature_sink_t *output_sink,
+        ei_dsp_config_spectral_analysis_t *config_ptr,
+        const float sampling_freq)
+    {
+        // scale the signal
+        int ret = numpy::scale(input_matrix, config_ptr->scale_axes);
+        if (ret != EIDSP_OK) {
+            ei_printf("ERR: Failed to scale signal (%d)\n", ret);
+            EIDSP_ERR(ret);
+        }
+
+        // transpose the matrix so we have one row per axis (nifty!)
+        ret = numpy::transpose(input_matrix);
+        if (ret != EIDSP_OK) {
+            ei_printf("ERR: Failed to transpose matrix (%d)\n", ret);
+            EIDSP_ERR(ret);
+        }
+
+        // the spectral edges that we want to calculate
+        matrix_t edges_matrix_in(64, 1);
+        EI_TRY(parse_spectral_power_edges(config_ptr->spectral_power_edges, &edges_matrix_in));
 
         // calculate how much room we need for the output matrix
         size_t output_matrix_cols = spectral::feature::calculate_spectral_buffer_size(
@@ -265,14 +371,10 @@ public:
             config_ptr->spectral_peaks_count,
             edges_matrix_in.rows);
         // ei_printf("output_matrix_size %hux%zu\n", input_matrix.rows, output_matrix_cols);
-        if (output_matrix->cols * output_matrix->rows !=
-            static_cast<uint32_t>(output_matrix_cols * config_ptr->axes)) {
+        if (output_sink->size != output_matrix_cols * config_ptr->axes) {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
         }
 
-        output_matrix->cols = output_matrix_cols;
-        output_matrix->rows = config_ptr->axes;
-
         spectral::filter_t filter_type;
         if (strcmp(config_ptr->filter_type, "low") == 0) {
             filter_type = spectral::filter_lowpass;
@@ -285,7 +387,7 @@ public:
         }
 
         ret = spectral::feature::spectral_analysis(
-            output_matrix,
+            output_sink,
             input_matrix,
             sampling_freq,
             filter_type,
@@ -300,10 +402,214 @@ public:
             EIDSP_ERR(ret);
         }
 
-        // flatten again
-        output_matrix->cols = config_ptr->axes * output_matrix_cols;
-        output_matrix->rows = 1;
+        return EIDSP_OK;
+    }
+
+    static void free_spectral_slice_state(spectral_slice_state_t *state)
+    {
+        if (state->moments) {
+            ei_free(state->moments);
+        }
+        if (state->head_fft) {
+            ei_free(state->head_fft);
+        }
+        if (state->filter_state) {
+            ei_free(state->filter_state);
+        }
+        memset(state, 0, sizeof(spectral_slice_state_t));
+    }
+
+    /**
+     * Sliced version of extract_spectral_analysis_features_v1, for continuous classification.
+     *
+     * v1 features only depend on the window mean and variance and on the first fft_length
+     * samples of the window (peaks on the mean removed FFT, power edges on the periodogram).
+     * So each slice is reduced once, when it arrives, to its moments and the FFT of its first
+     * fft_length samples; a window is then assembled from the ring without touching the raw
+     * data again. Removing the window mean only changes the DC bin of the cached FFT.
+     * Output is identical to the full window version on the same samples (up to float
+     * rounding), as long as there is no filter and a slice holds at least fft_length samples.
+     *
+     * With a low or high pass filter the signal is filtered as one stream instead: the
+     * Butterworth state carries over from slice to slice (primed on the first sample), so
+     * windows no longer start with the zero state edge transient the full window version has.
+     * The window mean is then removed after filtering rather than before.
+     *
+     * @param input_matrix Slice, one row per sample, one column per axis
+     * @param output_matrix Output features, same size as for the full window version
+     * @param window_ready Set to true once a whole model window of slices has been seen
+     * @returns 0 if OK
+     */
+    static int extract_spectral_analysis_features_v1_slice(
+        matrix_t *input_matrix,
+        matrix_t *output_matrix,
+        ei_dsp_config_spectral_analysis_t *config_ptr,
+        const float sampling_freq,
+        spectral_slice_state_t *state,
+        bool *window_ready)
+    {
+        const size_t slices = EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW;
+        const uint16_t fft_length = config_ptr->fft_length;
+        const size_t bins = fft_length / 2 + 1;
+        const size_t axes = config_ptr->axes;
+
+        *window_ready = false;
+
+        const filters::butterworth_sos_t *sos = NULL;
+        if (config_ptr->filter_order > 0 &&
+            (strcmp(config_ptr->filter_type, "low") == 0 || strcmp(config_ptr->filter_type, "high") == 0)) {
+            sos = filters::butterworth_sos(
+                strcmp(config_ptr->filter_type, "high") == 0,
+                config_ptr->filter_order,
+                sampling_freq,
+                config_ptr->filter_cutoff);
+            if (!sos) {
+                ei_printf("ERR: Continuous spectral analysis supports filters up to order %d\n",
+                    EIDSP_BUTTERWORTH_MAX_SECTIONS * 2);
+                EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+            }
+        }
+
+        if (input_matrix->cols != axes || input_matrix->rows < fft_length) {
+            ei_printf("ERR: Continuous spectral analysis needs slices of at least fft_length samples\n");
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        matrix_t edges_matrix_in(64, 1);
+        EI_TRY(parse_spectral_power_edges(config_ptr->spectral_power_edges, &edges_matrix_in));
+
+        const size_t output_matrix_cols = calculate_spectral_buffer_size(
+            true,
+            config_ptr->spectral_peaks_count,
+            edges_matrix_in.rows);
+        if (output_matrix->cols * output_matrix->rows != output_matrix_cols * axes) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        // (re)allocate the ring when the block changes
+        if (state->axes != axes || state->fft_length != fft_length || !state->moments) {
+            free_spectral_slice_state(state);
+            state->moments = (spectral_slice_moments_t *)ei_calloc(
+                slices * axes, sizeof(spectral_slice_moments_t));
+            state->head_fft = (fft_complex_t *)ei_calloc(slices * axes * bins, sizeof(fft_complex_t));
+            if (sos) {
+                state->filter_state = (float *)ei_calloc(filters::butterworth_sos_state_size(axes), sizeof(float));
+            }
+            if (!state->moments || !state->head_fft || (sos && !state->filter_state)) {
+                free_spectral_slice_state(state);
+                EIDSP_ERR(EIDSP_OUT_OF_MEM);
+            }
+            state->axes = axes;
+            state->fft_length = fft_length;
+        }
+
+        EI_TRY(numpy::scale(input_matrix, config_ptr->scale_axes));
+
+        // filter while the slice is still interleaved, all axes in one pass
+        if (sos) {
+            if (state->slices_seen == 0) {
+                filters::butterworth_sos_prime(sos, state->filter_state, input_matrix->buffer, axes, 1);
+            }
+            filters::butterworth_sos_apply(
+                sos, state->filter_state, input_matrix->buffer, input_matrix->rows, axes, axes, 1);
+        }
+
+        EI_TRY(numpy::transpose(input_matrix));
 
+        // reduce the new slice: moments and the FFT of its head
+        const size_t slot = state->next;
+        for (size_t row = 0; row < axes; row++) {
+            const float *x = input_matrix->buffer + (row * input_matrix->cols);
+            spectral_slice_moments_t *m = &state->moments[slot * axes + row];
+
+            numpy::moments_t slice_moments;
+            numpy::moments(x, input_matrix->cols, &slice_moments);
+            m->count = input_matrix->cols;
+            m->mean = slice_moments.mean;
+            m->m2 = slice_moments.m2;
+
+            EI_TRY(numpy::rfft(x, input_matrix->cols, &state->head_fft[(slot * axes + row) * bins], bins, fft_length));
+        }
+        state->next = (state->next + 1) % slices;
+        state->slices_seen++;
+
+        if (state->slices_seen < slices) {
+            return EIDSP_OK;
+        }
+
+        // the window starts with the slice the ring overwrites next
+        const size_t oldest = state->next;
+        const float periodogram_scale = 1.0f / (sampling_freq * fft_length);
+
+        EI_DSP_MATRIX(fft_matrix, 1, bins);
+        EI_DSP_MATRIX(period_fft_matrix, 1, bins);
+        EI_DSP_MATRIX(period_freq_matrix, 1, bins);
+        EI_DSP_MATRIX(peaks_matrix, config_ptr->spectral_peaks_count, 2);
+        EI_DSP_MATRIX(edges_matrix_out, edges_matrix_in.rows - 1, 1);
+
+        for (size_t ix = 0; ix < bins; ix++) {
+            period_freq_matrix.buffer[ix] = static_cast<float>(ix) * (1.0f / (fft_length * (1.0f / sampling_freq)));
+        }
+
+        for (size_t row = 0; row < axes; row++) {
+            // window mean and variance from the slices (Chan et al. pairwise update)
+            float n = 0.0f;
+            float mean = 0.0f;
+            float m2 = 0.0f;
+            for (size_t s = 0; s < slices; s++) {
+                const spectral_slice_moments_t *m = &state->moments[s * axes + row];
+                const float n_b = static_cast<float>(m->count);
+                const float delta = m->mean - mean;
+
+                m2 += m->m2 + delta * delta * n * n_b / (n + n_b);
+                mean += delta * n_b / (n + n_b);
+                n += n_b;
+            }
+
+            const fft_complex_t *head = &state->head_fft[(oldest * axes + row) * bins];
+
+            // peaks: |FFT| of the mean removed head, times 2/N
+            for (size_t ix = 0; ix < bins; ix++) {
+                float r = head[ix].r;
+                if (ix == 0) {
+                    r -= mean * fft_length;
+                }
+                fft_matrix.buffer[ix] = sqrt(r * r + head[ix].i * head[ix].i) * (2.0f / static_cast<float>(fft_length));
+            }
+            EI_TRY(spectral::processing::find_fft_peaks(&fft_matrix, &peaks_matrix,
+                sampling_freq, config_ptr->spectral_peaks_threshold, fft_length));
+
+            // periodogram of the head detrended by its own mean, which zeroes the DC bin
+            period_fft_matrix.buffer[0] = 0.0f;
+            for (size_t ix = 1; ix < bins; ix++) {
+                float p = (head[ix].r * head[ix].r + head[ix].i * head[ix].i) * periodogram_scale;
+                if (ix != static_cast<size_t>(fft_length / 2)) {
+                    p *= 2;
+                }
+                period_fft_matrix.buffer[ix] = p;
+            }
+            EI_TRY(spectral::processing::spectral_power_edges(
+                &period_fft_matrix,
+                &period_freq_matrix,
+                &edges_matrix_in,
+                &edges_matrix_out,
+                sampling_freq));
+
+            float *features_row = output_matrix->buffer + (row * output_matrix_cols);
+
+            size_t fx = 0;
+
+            features_row[fx++] = sqrt(m2 / n);
+            for (size_t peak_row = 0; peak_row < peaks_matrix.rows; peak_row++) {
+                features_row[fx++] = peaks_matrix.buffer[peak_row * peaks_matrix.cols + 0];
+                features_row[fx++] = peaks_matrix.buffer[peak_row * peaks_matrix.cols + 1];
+            }
+            for (size_t edge_row = 0; edge_row < edges_matrix_out.rows; edge_row++) {
+                features_row[fx++] = edges_matrix_out.buffer[edge_row * edges_matrix_out.cols] / 10.0f;
+            }
+        }
+
+        *window_ready = true;
         return EIDSP_OK;
     }
 
@@ -382,10 +688,6 @@ public:
             is_high_pass = true;
         }
 
-        if (remove_mean){
-            EI_TRY(processing::subtract_mean(input_matrix));
-        }
-
         // Figure bins we remove based on filter cutoff
         size_t start_bin, stop_bin;
         if (do_filter) {
@@ -409,36 +711,41 @@ public:
             float *data_window = input_matrix->get_row_ptr(row);
             size_t data_size = input_matrix->cols;
 
-            matrix_t rms_in_matrix(1, data_size, data_window);
-            matrix_t rms_out_matrix(1, 1, feature_out);
-            EI_TRY(numpy::rms(&rms_in_matrix, &rms_out_matrix));
-
-            feature_out++;
+            // RMS, skew and kurtosis from one pass over the axis, which also gives the mean
+            // we remove. See definition at https://en.wikipedia.org/wiki/Skewness
+            // See definition at https://en.wikipedia.org/wiki/Kurtosis
+            // With the mean removed RMS is the standard deviation, skew is mean(X^3) / stddev^3
+            // and kurtosis mean(X^4) / stddev^4. Note, this is the Fisher definition of
+            // Kurtosis, so subtract 3
+            // (see https://docs.scipy.org/doc/scipy/reference/generated/scipy.stats.kurtosis.html)
+            numpy::moments_t m;
+            numpy::moments(data_window, data_size, &m);
+
+            float s_sum = m.m3;
+            float k_sum = m.m4;
+            float rms;
+            if (remove_mean) {
+                for (size_t i = 0; i < data_size; i++) {
+                    data_window[i] -= m.mean;
+                }
+                rms = sqrt(m.m2 / data_size);
+            }
+            else {
+                // moments around zero instead of the mean
+                const float mean2 = m.mean * m.mean;
+                k_sum += 4.0f * m.mean * m.m3 + 6.0f * mean2 * m.m2 + data_size * mean2 * mean2;
+                s_sum += 3.0f * m.mean * m.m2 + data_size * mean2 * m.mean;
+                rms = sqrt((m.m2 + data_size * mean2) / data_size);
+            }
+            *feature_out++ = rms;
 
-            // Standard Deviation
-            float stddev = *(feature_out-1); //= sqrt(numpy::variance(data_window, data_size));
+            // Don't add std dev as a feature b/c it's the same as RMS
+            float stddev = rms;
             if (stddev == 0.0f) {
                 stddev = 1e-10f;
             }
-            // Don't add std dev as a feature b/c it's the same as RMS
-            // Skew and Kurtosis w/ shortcut:
-            // See definition at https://en.wikipedia.org/wiki/Skewness
-            // See definition at https://en.wikipedia.org/wiki/Kurtosis
-            // Substitute 0 for mean (b/c it is subtracted out above)
-            // Skew becomes: mean(X^3) / stddev^3
-            // Kurtosis becomes: mean(X^4) / stddev^4
-            // Note, this is the Fisher definition of Kurtosis, so subtract 3
-            // (see https://docs.scipy.org/doc/scipy/reference/generated/scipy.stats.kurtosis.html)
-            float s_sum = 0;
-            float k_sum = 0;
-            float temp;
-            for (size_t i = 0; i < data_size; i++) {
-                temp = data_window[i] * data_window[i] * data_window[i];
-                s_sum += temp;
-                k_sum += temp * data_window[i];
-            }
             // Skewness out
-            temp = stddev * stddev * stddev;
+            float temp = stddev * stddev * stddev;
             *feature_out++ = (s_sum / data_size) / temp;
             // Kurtosis out
             *feature_out++ = ((k_sum / data_size) / (temp * stddev)) - 3;
@@ -456,11 +763,15 @@ public:
                     config->fft_length,
                     config->do_fft_overlap));
 
-                matrix_t x(1, fft_out.size(), const_cast<float *>(fft_out.data()));
-                matrix_t out(1, 1);
+                // skew and kurtosis of the spectrum, both from one pass (as numpy::skew / kurtosis)
+                numpy::moments_t spectrum_moments;
+                numpy::moments(fft_out.data(), fft_out.size(), &spectrum_moments);
 
-                *feature_out++ = (numpy::skew(&x, &out) == EIDSP_OK) ? (out.get_row_ptr(0)[0]) : 0.0f;
-                *feature_out++ = (numpy::kurtosis(&x, &out) == EIDSP_OK) ? (out.get_row_ptr(0)[0]) : 0.0f;
+                const float n = static_cast<float>(fft_out.size());
+                const float var = spectrum_moments.m2 / n;
+                const float var_3_2 = sqrt(var * var * var);
+                *feature_out++ = (var_3_2 == 0.0f) ? 0.0f : (spectrum_moments.m3 / n) / var_3_2;
+                *feature_out++ = (var == 0.0f) ? -3.0f : (spectrum_moments.m4 / n) / (var * var) - 3.0f;
 
                 for (size_t i = start_bin; i < stop_bin; i++) {
                     feature_out[i - start_bin] = fft_out[i];
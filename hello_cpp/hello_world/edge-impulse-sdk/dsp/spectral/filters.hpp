@@ -153,6 +153,263 @@ namespace filters {
         ei_dsp_free(w2, n_steps*sizeof(float));
     }
 
+    // up to order 8, like butterworth_lowpass / butterworth_highpass
+    #define EIDSP_BUTTERWORTH_MAX_SECTIONS      4
+
+    /**
+     * Butterworth filter designed once, as a cascade of second order sections
+     * w[n] = x[n] + d1 w[n-1] + d2 w[n-2], y[n] = gain (w[n] +- 2 w[n-1] + w[n-2]).
+     * Same coefficients as butterworth_lowpass / butterworth_highpass.
+     */
+    typedef struct {
+        float sampling_freq;
+        float cutoff_freq;
+        uint8_t filter_order;
+        bool highpass;
+        uint8_t sections;
+        float gain[EIDSP_BUTTERWORTH_MAX_SECTIONS];
+        float d1[EIDSP_BUTTERWORTH_MAX_SECTIONS];
+        float d2[EIDSP_BUTTERWORTH_MAX_SECTIONS];
+    } butterworth_sos_t;
+
+    /**
+     * Number of floats of filter state butterworth_sos_apply needs for this many axes
+     */
+    static inline size_t butterworth_sos_state_size(size_t axes)
+    {
+        return EIDSP_BUTTERWORTH_MAX_SECTIONS * axes * 2;
+    }
+
+    /**
+     * Second order sections for a Butterworth filter, cached per design.
+     * @param filter_order Even filter order (between 2..8)
+     * @returns the design, or NULL if filter_order is above 8
+     */
+    static const butterworth_sos_t *butterworth_sos(
+        bool highpass,
+        int filter_order,
+        float sampling_freq,
+        float cutoff_freq)
+    {
+        static butterworth_sos_t cache[EIDSP_BUTTERWORTH_SOS_CACHE_SIZE > 0 ? EIDSP_BUTTERWORTH_SOS_CACHE_SIZE : 1] = { };
+        static size_t next = 0;
+
+        if (filter_order / 2 > EIDSP_BUTTERWORTH_MAX_SECTIONS) {
+            return NULL;
+        }
+
+        for (size_t ix = 0; ix < EIDSP_BUTTERWORTH_SOS_CACHE_SIZE; ix++) {
+            const butterworth_sos_t *c = &cache[ix];
+            if (c->filter_order == filter_order && c->highpass == highpass &&
+                c->sampling_freq == sampling_freq && c->cutoff_freq == cutoff_freq) {
+                return c;
+            }
+        }
+
+        butterworth_sos_t *sos = &cache[next];
+        next = (next + 1) % (EIDSP_BUTTERWORTH_SOS_CACHE_SIZE > 0 ? EIDSP_BUTTERWORTH_SOS_CACHE_SIZE : 1);
+
+        float a = tan(M_PI * cutoff_freq / sampling_freq);
+        float a2 = pow(a, 2);
+
+        sos->sampling_freq = sampling_freq;
+        sos->cutoff_freq = cutoff_freq;
+        sos->filter_order = filter_order;
+        sos->highpass = highpass;
+        sos->sections = filter_order / 2;
+        for (int ix = 0; ix < sos->sections; ix++) {
+            float r = sin(M_PI * ((2.0 * ix) + 1.0) / (2.0 * filter_order));
+            float s = a2 + (2.0 * a * r) + 1.0;
+            sos->gain[ix] = highpass ? 1.0f / s : a2 / s;
+            sos->d1[ix] = 2.0 * (1 - a2) / s;
+            sos->d2[ix] = -(a2 - (2.0 * a * r) + 1.0) / s;
+        }
+        return sos;
+    }
+
+    /**
+     * Run a filter over several axes at once, in place.
+     * Sample n of axis a is at data[n * frame_stride + a * axis_stride], so both interleaved
+     * frames (frame_stride = axes, axis_stride = 1) and one row per axis (frame_stride = 1,
+     * axis_stride = cols) work. The axes' recursions are independent, so they are interleaved
+     * per section rather than run one after another.
+     * @param state butterworth_sos_state_size(axes) floats, zero for a fresh start. Kept
+     *  across calls to continue the same signal.
+     */
+    static void butterworth_sos_apply(
+        const butterworth_sos_t *sos,
+        float *state,
+        float *data,
+        size_t frames,
+        size_t axes,
+        size_t frame_stride,
+        size_t axis_stride)
+    {
+        const float tap = sos->highpass ? -2.0f : 2.0f;
+
+        for (size_t sx = 0; sx < frames; sx++) {
+            float *frame = data + (sx * frame_stride);
+
+            for (uint8_t i = 0; i < sos->sections; i++) {
+                const float gain = sos->gain[i];
+                const float d1 = sos->d1[i];
+                const float d2 = sos->d2[i];
+                float *w = state + (i * axes * 2);
+
+                for (size_t ax = 0; ax < axes; ax++) {
+                    float *x = frame + (ax * axis_stride);
+                    const float w1 = w[ax * 2];
+                    const float w2 = w[ax * 2 + 1];
+                    const float w0 = d1 * w1 + d2 * w2 + *x;
+
+                    *x = gain * (w0 + tap * w1 + w2);
+                    w[ax * 2] = w0;
+                    w[ax * 2 + 1] = w1;
+                }
+            }
+        }
+    }
+
+    /**
+     * Set the state to where it settles on a constant input, so a stream does not start
+     * with a step transient from the signal's offset.
+     * @param frame First sample of each axis, at frame[a * axis_stride]
+     */
+    static void butterworth_sos_prime(
+        const butterworth_sos_t *sos,
+        float *state,
+        const float *frame,
+        size_t axes,
+        size_t axis_stride)
+    {
+        for (size_t ax = 0; ax < axes; ax++) {
+            float x = frame[ax * axis_stride];
+
+            for (uint8_t i = 0; i < sos->sections; i++) {
+                float *w = state + (i * axes * 2);
+                const float w_ss = x / (1.0f - sos->d1[i] - sos->d2[i]);
+
+                w[ax * 2] = w_ss;
+                w[ax * 2 + 1] = w_ss;
+                // DC gain is 1 for lowpass and 0 for highpass sections
+                x = sos->highpass ? 0.0f : x;
+            }
+        }
+    }
+
+    /**
+     * butterworth_sos_t in q30, for filtering integer signals.
+     * The state of the all-pole part grows well above the input (by ~1 / gain for low
+     * cutoffs), so the input has to be shifted down by `headroom` bits first to keep every
+     * intermediate within 32 bits.
+     */
+    typedef struct {
+        const butterworth_sos_t *design;
+        uint8_t headroom;
+        int32_t gain[EIDSP_BUTTERWORTH_MAX_SECTIONS];
+        int32_t d1[EIDSP_BUTTERWORTH_MAX_SECTIONS];
+        int32_t d2[EIDSP_BUTTERWORTH_MAX_SECTIONS];
+    } butterworth_sos_q31_t;
+
+    /**
+     * Fixed-point version of a Butterworth design, cached like butterworth_sos.
+     * Designing (and bounding the headroom from the impulse response) is float work,
+     * but it only happens the first time a design is seen.
+     * @returns the design, or NULL if filter_order is above 8
+     */
+    static const butterworth_sos_q31_t *butterworth_sos_q31(
+        bool highpass,
+        int filter_order,
+        float sampling_freq,
+        float cutoff_freq)
+    {
+        static butterworth_sos_q31_t cache[EIDSP_BUTTERWORTH_SOS_CACHE_SIZE > 0 ? EIDSP_BUTTERWORTH_SOS_CACHE_SIZE : 1] = { };
+        static size_t next = 0;
+
+        const butterworth_sos_t *sos = butterworth_sos(highpass, filter_order, sampling_freq, cutoff_freq);
+        if (!sos) {
+            return NULL;
+        }
+
+        // a float design can be evicted and its slot reused, so check the parameters as well
+        for (size_t ix = 0; ix < EIDSP_BUTTERWORTH_SOS_CACHE_SIZE; ix++) {
+            const butterworth_sos_q31_t *c = &cache[ix];
+            if (c->design == sos && c->design->filter_order == filter_order && c->design->highpass == highpass &&
+                c->design->sampling_freq == sampling_freq && c->design->cutoff_freq == cutoff_freq &&
+                c->gain[0] != 0) {
+                return c;
+            }
+        }
+
+        butterworth_sos_q31_t *q = &cache[next];
+        next = (next + 1) % (EIDSP_BUTTERWORTH_SOS_CACHE_SIZE > 0 ? EIDSP_BUTTERWORTH_SOS_CACHE_SIZE : 1);
+
+        q->design = sos;
+        for (int ix = 0; ix < sos->sections; ix++) {
+            q->gain[ix] = static_cast<int32_t>(round(sos->gain[ix] * 1073741824.0));
+            q->d1[ix] = static_cast<int32_t>(round(sos->d1[ix] * 1073741824.0));
+            q->d2[ix] = static_cast<int32_t>(round(sos->d2[ix] * 1073741824.0));
+        }
+
+        // largest L1 norm of any section's state or output for a unit impulse in; a bounded
+        // input can't take an intermediate above that times the input bound
+        double w[EIDSP_BUTTERWORTH_MAX_SECTIONS][2] = { };
+        double l1[EIDSP_BUTTERWORTH_MAX_SECTIONS][2] = { };
+        double bound = 1.0;
+        for (int n = 0; n < 65536; n++) {
+            double x = n == 0 ? 1.0 : 0.0;
+            double tail = 0.0;
+            for (int ix = 0; ix < sos->sections; ix++) {
+                const double w0 = sos->d1[ix] * w[ix][0] + sos->d2[ix] * w[ix][1] + x;
+                x = sos->gain[ix] * (w0 + (highpass ? -2.0 : 2.0) * w[ix][0] + w[ix][1]);
+                w[ix][1] = w[ix][0];
+                w[ix][0] = w0;
+                l1[ix][0] += fabs(w0);
+                l1[ix][1] += fabs(x);
+                tail += fabs(w0);
+            }
+            if (n > 64 && tail < 1e-12) {
+                break;
+            }
+        }
+        for (int ix = 0; ix < sos->sections; ix++) {
+            bound = l1[ix][0] > bound ? l1[ix][0] : bound;
+            bound = l1[ix][1] > bound ? l1[ix][1] : bound;
+        }
+        q->headroom = static_cast<uint8_t>(ceil(log2(bound)));
+
+        return q;
+    }
+
+    /**
+     * Run a fixed-point design over one signal, in place, from zero state.
+     * Input has to be below 2^31 >> headroom (the caller shifts); output is in the same units.
+     */
+    static void butterworth_sos_q31_apply(const butterworth_sos_q31_t *sos, int32_t *data, size_t size)
+    {
+        const uint8_t sections = sos->design->sections;
+        const int64_t tap = sos->design->highpass ? -2 : 2;
+        int32_t w[EIDSP_BUTTERWORTH_MAX_SECTIONS][2] = { };
+
+        for (size_t sx = 0; sx < size; sx++) {
+            int32_t x = data[sx];
+
+            for (uint8_t i = 0; i < sections; i++) {
+                const int32_t w1 = w[i][0];
+                const int32_t w2 = w[i][1];
+                const int32_t w0 = x + static_cast<int32_t>(
+                    ((int64_t)sos->d1[i] * w1 + (int64_t)sos->d2[i] * w2 + (1 << 29)) >> 30);
+
+                x = static_cast<int32_t>(
+                    ((int64_t)sos->gain[i] * ((int64_t)w0 + tap * w1 + w2) + (1 << 29)) >> 30);
+                w[i][0] = w0;
+                w[i][1] = w1;
+            }
+
+            data[sx] = x;
+        }
+    }
+
 } // namespace filters
 } // namespace spectral
 } // namespace ei
@@ -0,0 +1,516 @@
+/*
+ * Fixed-point spectral analysis (FFT, implementation version 1) for targets without an FPU,
+ * where every float operation is a soft-float library call.
+ *
+ * Per axis the samples are converted once to q31 with a block exponent, straight from their
+ * IEEE-754 bits, and everything that touches the samples after that is integer: mean removal,
+ * RMS (integer square root), the optional Butterworth filter (q30 second order sections), the
+ * real FFT (q31, divided by N), peak search and power buckets (64 bit accumulators). Floats
+ * only come back for what is per window rather than per sample: the config (edges, threshold,
+ * bin frequencies) and converting the finished features.
+ *
+ * The result matches spectral::feature::extract_spectral_analysis_features_v1 to roughly
+ * float precision; compare_with_float measures that on real windows (the app's
+ * SPECTRAL_ACCURACY native_sim build runs it over recorded IMU windows).
+ */
+#ifndef _EIDSP_SPECTRAL_FIXED_POINT_H_
+#define _EIDSP_SPECTRAL_FIXED_POINT_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "feature.hpp"
+#include "../fixed_rfft.hpp"
+
+#if EIDSP_USE_FIXED_POINT_SPECTRAL && !EIDSP_USE_FIXED_RFFT
+#error "EIDSP_USE_FIXED_POINT_SPECTRAL needs the compile time FFT tables (EIDSP_USE_FIXED_RFFT, C++14)"
+#endif
+
+#if EIDSP_USE_FIXED_RFFT
+
+namespace ei {
+namespace spectral {
+namespace fixed_point {
+
+// at most N / 4 local maxima in the N / 2 + 1 bins of a 256 point FFT
+static const size_t max_peak_candidates = 64;
+// power buckets (spectral power edges - 1)
+static const size_t max_power_buckets = 16;
+
+/**
+ * Fixed-point features against the float reference, over any number of windows
+ */
+typedef struct {
+    uint32_t windows;
+    uint32_t features;              // features per window
+    float max_abs_error;
+    uint32_t max_abs_error_feature; // feature index of max_abs_error
+    float max_scaled_error;         // error relative to the largest feature of its window
+    double sum_sq_error;
+} accuracy_t;
+
+static inline uint32_t float_bits(float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+/**
+ * v / 2^shift, rounded, from the bits of v (no float operations).
+ * The caller makes sure the result fits.
+ */
+static inline int32_t float_bits_to_fixed(uint32_t bits, int shift)
+{
+    const int32_t exponent = (bits >> 23) & 0xff;
+    if (exponent == 0) {
+        return 0; // zero and subnormals
+    }
+
+    // v = mantissa * 2^(exponent - 150)
+    const int32_t mantissa = (bits & 0x7fffff) | 0x800000;
+    const int k = exponent - 150 - shift;
+    int32_t q;
+    if (k >= 0) {
+        q = mantissa << k;
+    }
+    else if (k < -30) {
+        q = 0;
+    }
+    else {
+        q = (mantissa + (1 << (-k - 1))) >> -k;
+    }
+
+    return (bits & 0x80000000u) ? -q : q;
+}
+
+static inline uint32_t isqrt64(uint64_t v)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return static_cast<uint32_t>(res);
+}
+
+static inline int bit_length(uint32_t v)
+{
+    int bits = 0;
+    while (v) {
+        bits++;
+        v >>= 1;
+    }
+    return bits;
+}
+
+/**
+ * Shift a signal up (or down) so its largest magnitude is in [2^29, 2^30): full precision
+ * with one bit of headroom for the FFT. Adjusts the exponent to match.
+ */
+static void normalize(int32_t *x, size_t size, int *exponent)
+{
+    uint32_t max_abs = 0;
+    for (size_t ix = 0; ix < size; ix++) {
+        const uint32_t a = x[ix] < 0 ? -static_cast<uint32_t>(x[ix]) : x[ix];
+        max_abs = a > max_abs ? a : max_abs;
+    }
+    if (max_abs == 0) {
+        return;
+    }
+
+    const int shift = 30 - bit_length(max_abs);
+    if (shift > 0) {
+        for (size_t ix = 0; ix < size; ix++) {
+            x[ix] = static_cast<int32_t>(static_cast<uint32_t>(x[ix]) << shift);
+        }
+    }
+    else if (shift < 0) {
+        for (size_t ix = 0; ix < size; ix++) {
+            x[ix] >>= -shift;
+        }
+    }
+    *exponent -= shift;
+}
+
+/**
+ * sqrt(sum(x^2) / size), in the units of x
+ */
+static uint32_t rms(const int32_t *x, size_t size)
+{
+    // x^2 < 2^62, drop enough bits that size of them fit
+    int drop = 0;
+    while ((size >> drop) >= 4) {
+        drop++;
+    }
+
+    uint64_t acc = 0;
+    for (size_t ix = 0; ix < size; ix++) {
+        acc += static_cast<uint64_t>((int64_t)x[ix] * x[ix]) >> drop;
+    }
+
+    return isqrt64((acc / size) << drop);
+}
+
+/**
+ * Real FFT of n_fft points in q31, X[k] / n_fft interleaved (r, i)
+ * @param input n_fft points, used as scratch
+ * @param output 2 * n_fft values
+ */
+static int rfft(int32_t *input, int32_t *output, size_t n_fft)
+{
+    return fixed_fft::run_rfft_q31(input, output, n_fft) == EIDSP_OK ? EIDSP_OK : EIDSP_FFT_SIZE_NOT_SUPPORTED;
+}
+
+// Only the compile time tables; longer FFTs stay on the float path
+static bool can_do_rfft(size_t n_fft)
+{
+    return n_fft >= 16 && n_fft <= 256 && (n_fft & (n_fft - 1)) == 0;
+}
+
+static filter_t filter_type_of(const ei_dsp_config_spectral_analysis_t *config)
+{
+    if (strcmp(config->filter_type, "low") == 0) {
+        return filter_lowpass;
+    }
+    if (strcmp(config->filter_type, "high") == 0) {
+        return filter_highpass;
+    }
+    return filter_none;
+}
+
+/**
+ * Whether extract_spectral_analysis_features_v1 below handles this block
+ */
+static bool supports(const ei_dsp_config_spectral_analysis_t *config)
+{
+    if (strcmp(config->analysis_type, "FFT") != 0 || config->implementation_version != 1) {
+        return false;
+    }
+    if (!can_do_rfft(config->fft_length)) {
+        return false;
+    }
+    // Butterworth orders the second order sections cover
+    if (filter_type_of(config) != filter_none && config->filter_order / 2 > EIDSP_BUTTERWORTH_MAX_SECTIONS) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Fixed-point extract_spectral_analysis_features_v1
+ * @param input_matrix Raw window, one row per frame (frames x axes), as the signal delivers it.
+ *  Used as scratch.
+ * @returns EIDSP_NOT_SUPPORTED (before touching the input) for blocks `supports` rejects
+ */
+static int extract_spectral_analysis_features_v1(
+    matrix_t *input_matrix,
+    feature_sink_t *output_sink,
+    ei_dsp_config_spectral_analysis_t *config_ptr,
+    const float sampling_freq)
+{
+    if (!supports(config_ptr)) {
+        EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+    }
+
+    const size_t axes = config_ptr->axes;
+    const size_t n = input_matrix->rows * input_matrix->cols / axes;
+    const size_t n_fft = config_ptr->fft_length;
+    const size_t bins = n_fft / 2 + 1;
+    const size_t peaks_count = config_ptr->spectral_peaks_count;
+
+    matrix_t edges_matrix(64, 1);
+    EI_TRY(feature::parse_spectral_power_edges(config_ptr->spectral_power_edges, &edges_matrix));
+    const size_t buckets = edges_matrix.rows > 0 ? edges_matrix.rows - 1 : 0;
+    if (buckets > max_power_buckets) {
+        EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+    }
+
+    const size_t out_cols = feature::calculate_spectral_buffer_size(true, peaks_count, edges_matrix.rows);
+    if (output_sink->size != out_cols * axes) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    const filter_t filter_type = filter_type_of(config_ptr);
+    const filters::butterworth_sos_q31_t *sos = NULL;
+    if (filter_type != filter_none) {
+        sos = filters::butterworth_sos_q31(filter_type == filter_highpass, config_ptr->filter_order,
+            sampling_freq, config_ptr->filter_cutoff);
+        if (!sos) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+    }
+
+    matrix_i32_t signal(1, n);
+    matrix_i32_t fft_input(1, n_fft);
+    matrix_i32_t fft_output(1, 2 * n_fft);
+    if (!signal.buffer || !fft_input.buffer || !fft_output.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    // bin -> power bucket (or none), same float comparisons as processing::spectral_power_edges
+    uint8_t bucket_of_bin[129];
+    const bool bucket_map = bins <= sizeof(bucket_of_bin);
+    if (bucket_map) {
+        for (size_t ix = 0; ix < bins; ix++) {
+            const float t = static_cast<float>(ix) * (1.0f / (n_fft * (1.0f / sampling_freq)));
+            bucket_of_bin[ix] = 0xff;
+            for (size_t ex = 0; ex < buckets; ex++) {
+                if (t >= edges_matrix.buffer[ex] && t < edges_matrix.buffer[ex + 1]) {
+                    bucket_of_bin[ix] = ex;
+                    break;
+                }
+            }
+        }
+    }
+
+    // peak frequencies, as processing::find_fft_peaks' linspace
+    const uint32_t freq_count = n_fft / 2;
+    const float freq_stop = 1.0f / (2.0f * (1.0f / sampling_freq));
+    const float freq_step = freq_count > 1 ? freq_stop / (freq_count - 1) : 0.0f;
+
+    const float scale_axes = fabsf(config_ptr->scale_axes);
+
+    for (size_t axis = 0; axis < axes; axis++) {
+        const float *raw = input_matrix->buffer + axis;
+        int32_t *x = signal.buffer;
+        const size_t features_row = axis * out_cols;
+        size_t fx = 0;
+
+        // block exponent from the largest magnitude, so every |sample| < 2^29
+        int32_t max_exponent = 0;
+        for (size_t ix = 0; ix < n; ix++) {
+            const int32_t e = (float_bits(raw[ix * axes]) >> 23) & 0xff;
+            max_exponent = e > max_exponent ? e : max_exponent;
+        }
+
+        if (max_exponent == 0) {
+            for (size_t ix = 0; ix < out_cols; ix++) {
+                output_sink->write(features_row + ix, 0.0f);
+            }
+            continue;
+        }
+
+        // value = x * 2^exponent
+        int exponent = (max_exponent - 127) + 1 - 29;
+
+        int64_t sum = 0;
+        for (size_t ix = 0; ix < n; ix++) {
+            x[ix] = float_bits_to_fixed(float_bits(raw[ix * axes]), exponent);
+            sum += x[ix];
+        }
+
+        // remove the mean, |x| < 2^30 after
+        const int64_t half = static_cast<int64_t>(n / 2);
+        const int32_t mean = static_cast<int32_t>((sum >= 0 ? sum + half : sum - half) / static_cast<int64_t>(n));
+        for (size_t ix = 0; ix < n; ix++) {
+            x[ix] -= mean;
+        }
+
+        if (sos) {
+            // room for the filter's state, then back to full scale
+            for (size_t ix = 0; ix < n; ix++) {
+                x[ix] >>= sos->headroom;
+            }
+            exponent += sos->headroom;
+            filters::butterworth_sos_q31_apply(sos, x, n);
+        }
+        normalize(x, n, &exponent);
+        const uint32_t rms_q = rms(x, n);
+
+        // FFT of the first n_fft samples (zero padded), used for both the peaks and the periodogram
+        const size_t segment = n < n_fft ? n : n_fft;
+        memcpy(fft_input.buffer, x, segment * sizeof(int32_t));
+        memset(fft_input.buffer + segment, 0, (n_fft - segment) * sizeof(int32_t));
+        EI_TRY(rfft(fft_input.buffer, fft_output.buffer, n_fft));
+
+        const int32_t *spectrum = fft_output.buffer;
+        const float unit = ldexpf(scale_axes, exponent);
+
+        output_sink->write(features_row + fx++, rms_q * unit);
+
+        // peaks: local maxima of |X| in bin order (up to 10 per wanted peak), largest first
+        uint16_t peak_bins[max_peak_candidates];
+        uint32_t peak_mags[max_peak_candidates];
+        size_t peak_candidates = 0;
+        const size_t max_candidates = peaks_count * 10 < max_peak_candidates ? peaks_count * 10 : max_peak_candidates;
+
+        uint32_t prev = isqrt64((uint64_t)((int64_t)spectrum[0] * spectrum[0]) + (uint64_t)((int64_t)spectrum[1] * spectrum[1]));
+        uint32_t cur = isqrt64((uint64_t)((int64_t)spectrum[2] * spectrum[2]) + (uint64_t)((int64_t)spectrum[3] * spectrum[3]));
+        for (size_t ix = 1; ix < bins - 1 && peak_candidates < max_candidates; ix++) {
+            const int32_t *b = spectrum + 2 * (ix + 1);
+            const uint32_t next = isqrt64((uint64_t)((int64_t)b[0] * b[0]) + (uint64_t)((int64_t)b[1] * b[1]));
+
+            if (cur > prev && cur > next) {
+                peak_bins[peak_candidates] = ix;
+                peak_mags[peak_candidates] = cur;
+                peak_candidates++;
+            }
+            prev = cur;
+            cur = next;
+        }
+
+        // |X| / N -> the float path's 2 / N scaled magnitude
+        const float amplitude_unit = 2.0f * unit;
+        for (size_t peak = 0; peak < peaks_count; peak++) {
+            size_t best = peak_candidates;
+            for (size_t ix = 0; ix < peak_candidates; ix++) {
+                if (peak_mags[ix] > 0 && (best == peak_candidates || peak_mags[ix] > peak_mags[best])) {
+                    best = ix;
+                }
+            }
+
+            float freq = 0.0f;
+            float amplitude = 0.0f;
+            if (best != peak_candidates) {
+                amplitude = peak_mags[best] * amplitude_unit;
+                freq = peak_bins[best] == freq_count - 1 ? freq_stop : 0.0f + peak_bins[best] * freq_step;
+                peak_mags[best] = 0;
+                if (amplitude < config_ptr->spectral_peaks_threshold) {
+                    freq = 0.0f;
+                    amplitude = 0.0f;
+                }
+            }
+            output_sink->write(features_row + fx++, freq);
+            output_sink->write(features_row + fx++, amplitude);
+        }
+
+        // periodogram of the segment, detrended; with a full segment that only moves the DC bin
+        if (segment < n_fft) {
+            int64_t segment_sum = 0;
+            for (size_t ix = 0; ix < segment; ix++) {
+                segment_sum += x[ix];
+            }
+            const int32_t segment_mean = static_cast<int32_t>(segment_sum / static_cast<int64_t>(segment));
+            for (size_t ix = 0; ix < segment; ix++) {
+                fft_input.buffer[ix] = x[ix] - segment_mean;
+            }
+            memset(fft_input.buffer + segment, 0, (n_fft - segment) * sizeof(int32_t));
+            EI_TRY(rfft(fft_input.buffer, fft_output.buffer, n_fft));
+        }
+
+        // power per bucket in units of 2^(2 * exponent + 8), one sided (x2) except at Nyquist
+        uint64_t bucket_sum[max_power_buckets] = { };
+        uint32_t bucket_count[max_power_buckets] = { };
+        for (size_t ix = 0; ix < bins; ix++) {
+            size_t bucket = bucket_map ? bucket_of_bin[ix] : 0xff;
+            if (!bucket_map) {
+                const float t = static_cast<float>(ix) * (1.0f / (n_fft * (1.0f / sampling_freq)));
+                for (size_t ex = 0; ex < buckets; ex++) {
+                    if (t >= edges_matrix.buffer[ex] && t < edges_matrix.buffer[ex + 1]) {
+                        bucket = ex;
+                        break;
+                    }
+                }
+            }
+            if (bucket >= buckets) {
+                continue;
+            }
+
+            const int32_t *b = fft_output.buffer + 2 * ix;
+            uint64_t power = static_cast<uint64_t>((int64_t)b[0] * b[0]) + static_cast<uint64_t>((int64_t)b[1] * b[1]);
+            if (ix == 0 && segment >= n_fft) {
+                power = 0; // detrended
+            }
+            bucket_sum[bucket] += power >> (ix == n_fft / 2 ? 8 : 7);
+            bucket_count[bucket]++;
+        }
+
+        // X = N * (X / N), periodogram scale 1 / (fs * nperseg), and the features are / 10
+        const float power_unit = ldexpf(scale_axes * scale_axes, 2 * exponent + 8) *
+            (static_cast<float>(n_fft) * n_fft / (sampling_freq * segment * 10.0f));
+        for (size_t ex = 0; ex < buckets; ex++) {
+            float power = 0.0f;
+            if (bucket_count[ex] > 0) {
+                power = static_cast<float>(bucket_sum[ex] / bucket_count[ex]) * power_unit;
+            }
+            output_sink->write(features_row + fx++, power);
+        }
+    }
+
+    return EIDSP_OK;
+}
+
+/**
+ * Run one window through both the fixed-point and the float features and add the
+ * differences to `accuracy` (zero it before the first window).
+ * @param window Raw window, frames x axes interleaved, as the signal delivers it
+ */
+static int compare_with_float(
+    const float *window,
+    size_t window_size,
+    ei_dsp_config_spectral_analysis_t *config_ptr,
+    const float sampling_freq,
+    size_t feature_count,
+    accuracy_t *accuracy)
+{
+    const size_t frames = window_size / config_ptr->axes;
+
+    matrix_t fixed_out(1, feature_count);
+    matrix_t float_out(1, feature_count);
+    matrix_t input(frames, config_ptr->axes);
+    if (!fixed_out.buffer || !float_out.buffer || !input.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    memcpy(input.buffer, window, frames * config_ptr->axes * sizeof(float));
+    feature_sink_t sink(&fixed_out);
+    EI_TRY(extract_spectral_analysis_features_v1(&input, &sink, config_ptr, sampling_freq));
+
+    memcpy(input.buffer, window, frames * config_ptr->axes * sizeof(float));
+    EI_TRY(feature::extract_spectral_analysis_features_v1(&input, &float_out, config_ptr, sampling_freq));
+
+    float largest = 0.0f;
+    for (size_t ix = 0; ix < feature_count; ix++) {
+        largest = fabsf(float_out.buffer[ix]) > largest ? fabsf(float_out.buffer[ix]) : largest;
+    }
+
+    for (size_t ix = 0; ix < feature_count; ix++) {
+        const float err = fabsf(fixed_out.buffer[ix] - float_out.buffer[ix]);
+        if (err > accuracy->max_abs_error) {
+            accuracy->max_abs_error = err;
+            accuracy->max_abs_error_feature = ix;
+        }
+        if (largest > 0.0f && err / largest > accuracy->max_scaled_error) {
+            accuracy->max_scaled_error = err / largest;
+        }
+        accuracy->sum_sq_error += static_cast<double>(err) * err;
+    }
+    accuracy->features = feature_count;
+    accuracy->windows++;
+
+    return EIDSP_OK;
+}
+
+static void print_accuracy(const accuracy_t *accuracy)
+{
+    const uint32_t values = accuracy->windows * accuracy->features;
+
+    ei_printf("Fixed-point spectral features vs float over %u windows: max abs err ",
+        static_cast<unsigned>(accuracy->windows));
+    ei_printf_float(accuracy->max_abs_error);
+    ei_printf(" (feature %u), max err / largest feature ", static_cast<unsigned>(accuracy->max_abs_error_feature));
+    ei_printf_float(accuracy->max_scaled_error);
+    ei_printf(", rms err ");
+    ei_printf_float(values > 0 ? static_cast<float>(sqrt(accuracy->sum_sq_error / values)) : 0.0f);
+    ei_printf("\n");
+}
+
+} // namespace fixed_point
+} // namespace spectral
+} // namespace ei
+
+#endif // EIDSP_USE_FIXED_RFFT
+
+#endif // _EIDSP_SPECTRAL_FIXED_POINT_H_
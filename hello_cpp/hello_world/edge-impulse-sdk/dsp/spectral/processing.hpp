@@ -104,6 +104,33 @@ namespace processing {
         return numpy::scale(&temp, scale);
     }
 
+    /**
+     * Run a designed Butterworth filter over every row of the matrix, in place, from zero
+     * state. Rows are filtered together, up to 8 at a time, in a single pass over the columns.
+     * @returns 0 when successful
+     */
+    static int butterworth_sos_filter(const filters::butterworth_sos_t *sos, matrix_t *matrix)
+    {
+        const size_t max_rows = 8;
+        float state[EIDSP_BUTTERWORTH_MAX_SECTIONS * max_rows * 2];
+
+        for (size_t row = 0; row < matrix->rows; row += max_rows) {
+            const size_t rows = matrix->rows - row < max_rows ? matrix->rows - row : max_rows;
+
+            memset(state, 0, filters::butterworth_sos_state_size(rows) * sizeof(float));
+            filters::butterworth_sos_apply(
+                sos,
+                state,
+                matrix->buffer + (row * matrix->cols),
+                matrix->cols,
+                rows,
+                1,
+                matrix->cols);
+        }
+
+        return EIDSP_OK;
+    }
+
     /**
      * Filter data along one-dimension with an IIR or FIR filter using
      * Butterworth digital and analog filter design.
@@ -120,17 +147,23 @@ namespace processing {
         float filter_cutoff,
         uint8_t filter_order)
     {
-        for (size_t row = 0; row < matrix->rows; row++) {
-            filters::butterworth_lowpass(
-                filter_order,
-                sampling_frequency,
-                filter_cutoff,
-                matrix->buffer + (row * matrix->cols),
-                matrix->buffer + (row * matrix->cols),
-                matrix->cols);
+        const filters::butterworth_sos_t *sos = filters::butterworth_sos(
+            false, filter_order, sampling_frequency, filter_cutoff);
+
+        if (!sos) {
+            for (size_t row = 0; row < matrix->rows; row++) {
+                filters::butterworth_lowpass(
+                    filter_order,
+                    sampling_frequency,
+                    filter_cutoff,
+                    matrix->buffer + (row * matrix->cols),
+                    matrix->buffer + (row * matrix->cols),
+                    matrix->cols);
+            }
+            return EIDSP_OK;
         }
 
-        return EIDSP_OK;
+        return butterworth_sos_filter(sos, matrix);
     }
 
     /**
@@ -149,17 +182,23 @@ namespace processing {
         float filter_cutoff,
         uint8_t filter_order)
     {
-        for (size_t row = 0; row < matrix->rows; row++) {
-            filters::butterworth_highpass(
-                filter_order,
-                sampling_frequency,
-                filter_cutoff,
-                matrix->buffer + (row * matrix->cols),
-                matrix->buffer + (row * matrix->cols),
-                matrix->cols);
+        const filters::butterworth_sos_t *sos = filters::butterworth_sos(
+            true, filter_order, sampling_frequency, filter_cutoff);
+
+        if (!sos) {
+            for (size_t row = 0; row < matrix->rows; row++) {
+                filters::butterworth_highpass(
+                    filter_order,
+                    sampling_frequency,
+                    filter_cutoff,
+                    matrix->buffer + (row * matrix->cols),
+                    matrix->buffer + (row * matrix->cols),
+                    matrix->cols);
+            }
+            return EIDSP_OK;
         }
 
-        return EIDSP_OK;
+        return butterworth_sos_filter(sos, matrix);
     }
 
     /**
@@ -276,6 +315,8 @@ namespace processing {
 
         // turn this into C++ vector and sort it based on amplitude
         ei_vector<freq_peak_t> peaks;
+        // one allocation instead of one per growth step
+        peaks.reserve(peak_count > output_matrix->rows ? peak_count : output_matrix->rows);
         for (uint8_t ix = 0; ix < peak_count; ix++) {
             freq_peak_t d;
 
@@ -449,10 +490,18 @@ namespace processing {
             EIDSP_ERR(ret);
         }
 
-        fft_complex_t *fft_output = (fft_complex_t*)ei_dsp_calloc((n_fft / 2 + 1) * sizeof(fft_complex_t), 1);
+        // use the rfft plan's output buffer when there is one, saves an allocation per call
+        numpy::rfft_plan_t *plan = numpy::get_rfft_plan(n_fft);
+        fft_complex_t *fft_output = plan ? plan->output :
+            (fft_complex_t*)ei_dsp_calloc((n_fft / 2 + 1) * sizeof(fft_complex_t), 1);
+        if (!fft_output) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
         ret = numpy::rfft(welch_matrix.buffer, welch_matrix.cols, fft_output, n_fft / 2 + 1, n_fft);
         if (ret != EIDSP_OK) {
-            ei_dsp_free(fft_output, (n_fft / 2 + 1) * sizeof(fft_complex_t));
+            if (!plan) {
+                ei_dsp_free(fft_output, (n_fft / 2 + 1) * sizeof(fft_complex_t));
+            }
             EIDSP_ERR(ret);
         }
 
@@ -472,7 +521,9 @@ namespace processing {
             out_fft_matrix->buffer[ix] = fft_output[ix].r;
         }
 
-        ei_dsp_free(fft_output, (n_fft / 2 + 1) * sizeof(fft_complex_t));
+        if (!plan) {
+            ei_dsp_free(fft_output, (n_fft / 2 + 1) * sizeof(fft_complex_t));
+        }
 
         return EIDSP_OK;
     }
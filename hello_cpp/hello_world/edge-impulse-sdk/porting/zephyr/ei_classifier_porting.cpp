@@ -48,7 +48,12 @@ uint64_t ei_read_timer_ms() {
 }
 
 uint64_t ei_read_timer_us() {
-    return k_uptime_get() * 1000;
+    // k_uptime_get() only has ms resolution, too coarse for DSP and inference timing
+#if defined(CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER)
+    return k_cyc_to_us_floor64(k_cycle_get_64());
+#else
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+#endif
 }
 
 EI_WEAK_FN char ei_getchar()
@@ -25,6 +25,14 @@ namespace RTOS
 		{ t.End () } -> std::same_as < void >;
 	};
 
+	/**
+	 * An ActiveObject gets acc_data_chan / controls_chan forwarded into its input queue
+	 * (0x98 / 0x99) unless it declares static constexpr bool cForwardsChannels = false.
+	 * Opting out also drops its SubscriberTask, so only its own Send()s reach the queue.
+	 */
+	template <typename T>
+	concept ForwardsChannels = !requires { T::cForwardsChannels; } || T::cForwardsChannels;
+
     template <class D>
     class ActiveObject
     {
@@ -38,22 +46,24 @@ namespace RTOS
 			auto res = mHandle.set_name(mName);
 			if(res.has_value() == false)
 				return false;
-            const struct zbus_channel* chans[] = {&acc_data_chan, &controls_chan};
-            for (auto* chan : chans) {
-                if (!chan) {
-                    // LOG_WRN("Null channel in init()");
-                    continue;
+            if constexpr (ForwardsChannels<D>) {
+                const struct zbus_channel* chans[] = {&acc_data_chan, &controls_chan};
+                for (auto* chan : chans) {
+                    if (!chan) {
+                        // LOG_WRN("Null channel in init()");
+                        continue;
+                    }
+                    int ret = zbus_chan_add_obs(chan, ActiveObject::mSub, K_NO_WAIT);
+                    if (ret != 0) {
+                        // LOG_ERR("Failed to subscribe to channel %s, err=%d",
+                        //         zbus_chan_name(chan), ret);
+                    } else {
+                        // LOG_INF("Subscribed to channel %s", zbus_chan_name(chan));
+                    }
                 }
-                int ret = zbus_chan_add_obs(chan, ActiveObject::mSub, K_NO_WAIT);
-                if (ret != 0) {
-                    // LOG_ERR("Failed to subscribe to channel %s, err=%d",
-                    //         zbus_chan_name(chan), ret);
-                } else {
-                    // LOG_INF("Subscribed to channel %s", zbus_chan_name(chan));
-                }
-            }
 
-            RTOS::Hal::TaskCreate(&SubscriberTask, "mName", &mZbusHandle);
+                RTOS::Hal::TaskCreate(&SubscriberTask, "mName", &mZbusHandle);
+            }
 
 			return RTOS::Hal::TaskCreate(&Run, mName, &mHandle);
         };
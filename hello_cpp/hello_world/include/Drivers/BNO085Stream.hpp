@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Drivers/BNO085.h>
+#include <Drivers/ImuReportScheduler.hpp>
+#include <Drivers/QuaternionFrontEnd.hpp>
+#include <Drivers/ShtpAsync.hpp>
+#include <Drivers/ShtpCapture.hpp>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <cstddef>
+#include <cstdint>
+
+/** Boards that wire H_INTN (bno085-int-gpios in the zephyr,user node) */
+#define BNO085_HAS_INT DT_NODE_HAS_PROP(DT_PATH(zephyr_user), bno085_int_gpios)
+
+/**
+ * Block of orientation samples in SoA layout, one array per component.
+ * Timestamps are grid ticks on the sensor hub's clock (sh2 event timestamps), not the time we
+ * read the bus.
+ */
+template <size_t N>
+struct ImuBlock {
+    static constexpr size_t cCapacity = N;
+
+    size_t      count;
+    uint64_t    t_us[N];
+    float       qi[N];
+    float       qj[N];
+    float       qk[N];
+    float       qr[N];
+};
+
+/**
+ * Interrupt driven BNO085 ingestion that never blocks on the bus.
+ * The sh2 HAL's read/write go through an ShtpAsyncHal: the H_INTN ISR starts reading the pending
+ * SHTP transfer in the background, and its completion calls the Notify() hook, which wakes the
+ * ingestion thread. The thread then Drain()s: one sh2_service() per transfer already in memory,
+ * and the next background read while the line stays asserted.
+ * Decoded reports go through an ImuReportScheduler, which resamples them onto the model's rate
+ * grid into an ImuBlock. Full blocks (and whatever is left at the end of a drain) go through a
+ * QuaternionFrontEnd into EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME-wide frames, written straight into
+ * the window Service::Acquisition is filling.
+ *
+ * Needs the H_INTN pin in devicetree, e.g.
+ *     zephyr,user { bno085-int-gpios = <&gpio0 4 GPIO_ACTIVE_LOW>; };
+ * and is compiled out on boards without it. StartReplay()/RunReplay() run the same pipeline
+ * from an ShtpReplay capture instead of the hub; they still need the sh2/SHTP sources, which
+ * this tree does not vendor, so native_sim cannot build them yet.
+ */
+class BNO085Stream : public BNO085
+{
+public:
+    static constexpr size_t cBlockFrames = 16;
+    static constexpr uint8_t cI2cAddress = 0x4A;    /**< begin()'s default, SA0 low */
+
+    /**
+     * Opens the hub over Wire, enables the reports the selected fusion axes need and arms
+     * H_INTN. For the compiled impulse: Start(ei_dsp_config_7_axes, ei_dsp_config_7_axes_size,
+     * EI_CLASSIFIER_FREQUENCY).
+     */
+    bool Start(const uint8_t* axes, size_t axesCount, uint32_t rateHz);
+
+    /** Called once a transfer has landed (I2C completion, ISR or work queue); set before Start(). */
+    void Notify(void (*notify)()) { mNotify = notify; }
+
+    /** Hands the transfers read so far to sh2, from the thread Notify() wakes; never waits on the bus. */
+    void Drain();
+
+    /** Records every SHTP transfer of the next Start() (set before it, nullptr to stop). */
+    void Record(ShtpRecorder* recorder) { mRecorder = recorder; }
+
+    /** Like Start(), but opens sh2 on a capture; the session must match the recorded one. */
+    bool StartReplay(ShtpReplay& replay, const uint8_t* axes, size_t axesCount, uint32_t rateHz);
+
+    /** Drains the capture through the pipeline and logs throughput; returns frames produced. */
+    uint32_t RunReplay(ShtpReplay& replay);
+
+    uint32_t Frames() const { return mFrames; }
+    uint32_t SkippedTicks() const { return mScheduler.SkippedTicks(); }
+
+protected:
+    bool _init(int32_t sensor_id = 0) override;
+
+private:
+    static void OnInterrupt(const struct device *port, struct gpio_callback *cb, uint32_t pins);
+    static void OnTransfer();
+    static void OnHubEvent(void *cookie, sh2_AsyncEvent_t *event);
+    static void OnSensorEvent(void *cookie, sh2_SensorEvent_t *event);
+    static void OnGridSample(const ImuReportScheduler::Sample& sample, void* user);
+
+    bool Configure(const uint8_t* axes, size_t axesCount, uint32_t rateHz);
+    bool Asserted() const;
+    void Flush();
+
+    ImuReportScheduler      mScheduler;
+    QuaternionFrontEnd      mFrontEnd{nullptr, 0};
+    ImuBlock<cBlockFrames>  mBlock{};
+    ShtpRecorder*           mRecorder = nullptr;
+    ShtpAsyncHal            mAsync{Wire, cI2cAddress};
+    struct gpio_callback    mIntCallback{};
+    void                    (*mNotify)() = nullptr;
+    uint32_t                mFrames = 0;
+};
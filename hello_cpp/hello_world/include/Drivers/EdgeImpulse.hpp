@@ -1,6 +1,83 @@
 // https://github.com/edgeimpulse/inferencing-sdk-cpp/blob/master/porting/zephyr/ei_classifier_porting.cpp
+#pragma once
 
+#include <edge-impulse-sdk/classifier/ei_classifier_types.h>
+#include <model-parameters/model_metadata.h>
+#include <cstddef>
+#include <cstdint>
+
+/* Quantized EON model with an int8 input tensor: feature vectors travel as the tensor holds them */
+#if EI_CLASSIFIER_QUANTIZATION_ENABLED == 1 && EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE && \
+    EI_CLASSIFIER_COMPILED == 1 && EI_CLASSIFIER_TFLITE_INPUT_DATATYPE == EI_CLASSIFIER_DATATYPE_INT8
+#define EIMPULSE_INT8_FEATURES 1
+#else
+#define EIMPULSE_INT8_FEATURES 0
+#endif
+
+/**
+ * The compiled impulse (model-parameters/ + tflite-model/).
+ * Only EdgeImpulse.cpp includes ei_run_classifier.h: the SDK defines run_classifier() and
+ * friends in that header, a second translation unit would define them twice.
+ *
+ * Run() is run_classifier() on one window. Extract() + Classify() are the same two halves
+ * (DSP, NN) callable from different threads, for impulses with one stateless DSP block and
+ * learning blocks that do not keep their output; anything else fails with an EI_IMPULSE_ERROR.
+ * With EIMPULSE_INT8_FEATURES a Feature is the int8 the input tensor takes: Extract() quantizes
+ * on write (spectral analysis straight through the SDK's int8 feature sink, as
+ * run_classifier() does) and Classify() copies the vector into the tensor, which needs a
+ * single NN learning block.
+ */
 class EImpulse {
 public:
-    static int Run();
-};
\ No newline at end of file
+    /** One window: EI_CLASSIFIER_RAW_SAMPLE_COUNT interleaved frames, as the DSP block reads it */
+    static constexpr size_t cWindowFloats = EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+    static constexpr size_t cLabelCount = EI_CLASSIFIER_LABEL_COUNT;
+    static constexpr size_t cFeatureCount = EI_CLASSIFIER_NN_INPUT_FRAME_SIZE;
+#if EIMPULSE_INT8_FEATURES
+    using Feature = int8_t;
+#else
+    using Feature = float;
+#endif
+
+    /**
+     * Resets the classifier state; call once before the first Run() or Extract() (which needs
+     * the input quantization read here with EIMPULSE_INT8_FEATURES).
+     */
+    static void Init();
+
+    /**
+     * Classifies one window of cWindowFloats floats. result.timing holds the DSP and NN time.
+     * @return EI_IMPULSE_OK (0) or the EI_IMPULSE_ERROR of the failing stage.
+     */
+    static int Run(const float* window, ei_impulse_result_t& result);
+
+    /** DSP half: the cFeatureCount features of one window, written in place into features. */
+    static int Extract(const float* window, Feature* features);
+
+    /**
+     * NN half: classifies features from Extract(). Only result.timing.classification_us is
+     * set, the DSP time is the caller's.
+     */
+    static int Classify(Feature* features, ei_impulse_result_t& result);
+
+    /** Index of the best scoring label in result.classification */
+    static size_t Best(const ei_impulse_result_t& result);
+
+    static const char* Label(size_t ix);
+
+    /** Indices of the fusion axes the DSP block reads, for BNO085Stream::Start() */
+    static const uint8_t* Axes();
+    static size_t AxesCount();
+
+#if SPECTRAL_ACCURACY
+    /**
+     * Runs one window through the fixed-point and the float spectral features and adds the
+     * difference to the running totals; the DSP block must be spectral analysis (FFT, v1).
+     * @return EI_IMPULSE_OK (0) or EI_IMPULSE_DSP_ERROR.
+     */
+    static int CompareFixedPoint(const float* window);
+
+    /** Prints the totals of every CompareFixedPoint() so far (ei_printf) */
+    static void PrintFixedPointAccuracy();
+#endif /* SPECTRAL_ACCURACY */
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Drivers/sh2.h>
+#include <Drivers/sh2_SensorValue.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Decides which SH2 reports an impulse needs and puts them on one time grid.
+ *
+ * Plan() turns a feature set (usually parsed from the impulse's fusion string and axes
+ * selection) into the smallest set of reports, all at the lowest interval that still brackets
+ * every grid tick. Push() then takes decoded reports with their SH2 timestamps and emits one
+ * Sample per tick of the rateHz grid, interpolated between the two reports around it
+ * (nlerp for the quaternion, linear otherwise). Reports nobody asked for are never enabled.
+ */
+class ImuReportScheduler
+{
+public:
+    enum Feature : uint32_t {
+        Roll    = 1U << 0,
+        Pitch   = 1U << 1,
+        Yaw     = 1U << 2,
+        QX      = 1U << 3,
+        QY      = 1U << 4,
+        QZ      = 1U << 5,
+        QW      = 1U << 6,
+        AccX    = 1U << 7,
+        AccY    = 1U << 8,
+        AccZ    = 1U << 9,
+        GyrX    = 1U << 10,
+        GyrY    = 1U << 11,
+        GyrZ    = 1U << 12,
+    };
+    static constexpr uint32_t cOrientation = Roll | Pitch | Yaw | QX | QY | QZ | QW;
+    static constexpr uint32_t cAccel = AccX | AccY | AccZ;
+    static constexpr uint32_t cGyro = GyrX | GyrY | GyrZ;
+    static constexpr size_t cMaxReports = 3;
+
+    struct Report {
+        sh2_SensorId_t  id;
+        uint32_t        intervalUs;
+    };
+
+    struct Sample {
+        uint64_t    t_us;
+        float       q[4];       /**< i, j, k, real */
+        float       acc[3];
+        float       gyr[3];
+    };
+
+    using Emit = void (*)(const Sample& sample, void* user);
+
+    /**
+     * Features named by the fusion string ("roll + pitch + yaw + qX + ...") at the given axes
+     * offsets, e.g. EI_CLASSIFIER_FUSION_AXES_STRING with ei_dsp_config_7_axes.
+     */
+    static uint32_t FeaturesFromFusion(const char* fusion, const uint8_t* axes, size_t count);
+
+    /**
+     * Minimal report set for the features at rateHz, written to out (cMaxReports entries).
+     * Yaw needs the magnetometer referenced rotation vector; roll/pitch/quaternion alone get
+     * by with the game rotation vector, which keeps the magnetometer off.
+     * @return number of reports to enable; 0 for a rateHz of 0 or above 1 MHz.
+     */
+    size_t Plan(uint32_t features, uint32_t rateHz, Report* out);
+
+    /** Feeds one decoded report; emits every grid tick it completes. */
+    void Push(const sh2_SensorValue_t& value, Emit emit, void* user);
+
+    uint32_t Features() const { return mFeatures; }
+    /** Grid ticks no longer covered by the report history (a report was lost or late). */
+    uint32_t SkippedTicks() const { return mSkippedTicks; }
+
+private:
+    enum Stream : uint8_t { Orientation = 0, Accel, Gyro, StreamCount };
+
+    /** Last reports of one stream, oldest first; deep enough to ride out bursty delivery */
+    static constexpr uint8_t cDepth = 4;
+    struct History {
+        uint64_t    t[cDepth];
+        float       v[cDepth][4];
+        uint8_t     count;
+    };
+
+    bool Interpolate(uint64_t t, Sample& out) const;
+
+    uint32_t    mFeatures = 0;
+    uint32_t    mRateHz = 0;
+    uint8_t     mStreams = 0;       /**< bitmask of Stream */
+    History     mHistory[StreamCount]{};
+    uint64_t    mT0 = 0;
+    uint64_t    mTick = 0;
+    bool        mGridStarted = false;
+    uint32_t    mSkippedTicks = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Block conversion of rotation-vector samples into impulse input frames.
+ *
+ * Works on SoA blocks (see ImuBlock) a chunk at a time: quaternions are turned into the
+ * rotation-matrix terms Euler angles are read from (CMSIS-DSP arm_quaternion2rotation_f32 on
+ * Cortex-M builds, the same terms computed inline elsewhere), then roll/pitch/yaw come from a
+ * branch-free polynomial atan2 over the whole chunk instead of one atan2f()/asinf() per sample.
+ * Angles match BNO085::getRoll()/getPitch()/getYaw() (radians) to better than 1e-4 rad.
+ *
+ * Output frames follow the impulse's axes selection into its fusion string
+ * ("roll + pitch + yaw + qX + qY + qZ + qW"), i.e. pass ei_dsp_config_7_axes and
+ * ei_dsp_config_7_axes_size and each frame is exactly what the DSP block reads.
+ */
+class QuaternionFrontEnd
+{
+public:
+    /** Index of each feature in the fusion string */
+    enum Axis : uint8_t { Roll = 0, Pitch, Yaw, QX, QY, QZ, QW, AxisCount };
+
+    static constexpr size_t cChunk = 8;
+
+    QuaternionFrontEnd(const uint8_t* axes, size_t axesCount) : mAxes(axes), mAxesCount(axesCount) {}
+
+    size_t FrameWidth() const { return mAxesCount; }
+
+    /** Converts count samples into count * FrameWidth() interleaved floats at out. */
+    void Convert(const float* qi, const float* qj, const float* qk, const float* qr, size_t count,
+                 float* out) const;
+
+private:
+    const uint8_t*  mAxes;
+    size_t          mAxesCount;
+};
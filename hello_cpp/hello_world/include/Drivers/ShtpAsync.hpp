@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Drivers/Wire.h>
+#include <Drivers/sh2_hal.h>
+#include <zephyr/sys/atomic.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Reads one SHTP transfer from a BNO08x over I2C without blocking the caller.
+ * The 4-byte header read and the payload read are chained from the transport's completion
+ * callback, straight into the caller's buffer; done(len) runs once the whole cargo
+ * (header included, as the hub resends it) is in, or done(-errno) on failure.
+ */
+class ShtpAsyncReader
+{
+public:
+    using DoneCallback = void (*)(int lenOrError, void *user);
+
+    static constexpr size_t cHeaderLen = 4;
+
+    ShtpAsyncReader(TwoWire &bus, uint8_t address) : mBus(bus), mAddress(address) {}
+
+    int Read(uint8_t *buffer, size_t capacity, DoneCallback done, void *user);
+
+private:
+    static void OnHeader(int result, void *self);
+    static void OnCargo(int result, void *self);
+
+    TwoWire&        mBus;
+    uint8_t         mAddress;
+    uint8_t         mHeader[cHeaderLen];
+    uint8_t*        mBuffer = nullptr;
+    size_t          mCapacity = 0;
+    size_t          mLength = 0;
+    DoneCallback    mDone = nullptr;
+    void*           mUser = nullptr;
+};
+
+/**
+ * Non-blocking sh2_Hal_t read/write for a hub on I2C.
+ * Wrap() swaps the HAL's read/write for ones backed by an ShtpAsyncReader and writeAsync(), so
+ * it must run after the HAL is filled in and before sh2_open() (and before ShtpRecorder::Wrap(),
+ * which then records these). Kick() starts reading the next transfer in the background, e.g.
+ * from the H_INTN ISR; its completion calls the ready hook, and the next read() hands the
+ * transfer to sh2 from memory. read() never touches the bus itself beyond kicking a read when
+ * idle, which is what keeps sh2_open() and other polling sh2 calls moving. write() copies the
+ * transfer and returns 0 (sh2 retries) while the previous write is still on the bus.
+ */
+class ShtpAsyncHal
+{
+public:
+    using ReadyCallback = void (*)();
+
+    ShtpAsyncHal(TwoWire &bus, uint8_t address) : mReader(bus, address), mBus(bus), mAddress(address) {}
+
+    /** One hal at a time. ready runs in the I2C completion context (ISR or work queue). */
+    void Wrap(sh2_Hal_t &hal, ReadyCallback ready);
+
+    /** Starts reading the next transfer unless one is in flight or waiting; ISR safe. */
+    void Kick();
+
+    /** A whole transfer is waiting for the next sh2_service() */
+    bool Ready() const { return atomic_get(&mState) == cFull; }
+
+private:
+    static constexpr atomic_val_t cIdle = 0;
+    static constexpr atomic_val_t cReading = 1;
+    static constexpr atomic_val_t cFull = 2;
+
+    static int Read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us);
+    static int Write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len);
+    static void OnRead(int lenOrError, void *user);
+    static void OnWrite(int result, void *user);
+
+    ShtpAsyncReader mReader;
+    TwoWire&        mBus;
+    uint8_t         mAddress;
+    sh2_Hal_t       mInner{};
+    sh2_Hal_t*      mHal = nullptr;
+    ReadyCallback   mReady = nullptr;
+    atomic_t        mState = ATOMIC_INIT(cIdle);
+    atomic_t        mWriting = ATOMIC_INIT(0);
+    int             mRxLength = 0;
+    uint32_t        mRxUs = 0;      /**< HAL time the read was kicked, i.e. the interrupt */
+    uint8_t         mRx[SH2_HAL_MAX_TRANSFER_IN];
+    uint8_t         mTx[SH2_HAL_MAX_TRANSFER_OUT];
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Drivers/sh2_hal.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * SHTP capture format, little endian:
+ *     file header  "SHTP", version (1), flags (0), reserved (2 bytes)
+ *     record       t_us (4), length | cShtpCaptureOut (2), length bytes of transfer
+ * t_us is the HAL timestamp of the transfer, i.e. what sh2 sees as the interrupt time.
+ */
+static constexpr uint8_t  cShtpCaptureVersion = 1;
+static constexpr size_t   cShtpCaptureFileHeader = 8;
+static constexpr size_t   cShtpCaptureRecordHeader = 6;
+static constexpr uint16_t cShtpCaptureOut = 0x8000;   /**< host to hub transfer */
+
+/**
+ * Records every SHTP transfer of a live sh2_Hal_t.
+ * Wrap() swaps the HAL's read/write for recording trampolines, so it must run after the HAL is
+ * filled in and before sh2_open(). Each transfer is handed to the sink as one whole record;
+ * the sink decides where the capture goes (flash, UART, a host file on native_sim).
+ */
+class ShtpRecorder
+{
+public:
+    using Sink = void (*)(const uint8_t *data, size_t len, void *user);
+
+    ShtpRecorder(Sink sink, void *user) : mSink(sink), mUser(user) {}
+
+    /** Writes the file header and starts recording the hal's transfers. One hal at a time. */
+    void Wrap(sh2_Hal_t &hal);
+
+    uint32_t Records() const { return mRecords; }
+
+private:
+    static int Read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us);
+    static int Write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len);
+
+    void Emit(uint32_t t_us, const uint8_t *data, unsigned len, uint16_t direction);
+
+    Sink        mSink;
+    void*       mUser;
+    sh2_Hal_t   mInner{};
+    uint32_t    mRecords = 0;
+};
+
+/**
+ * sh2_Hal_t that plays a capture back instead of talking to a hub.
+ * Inbound transfers are returned by read() in order; writes are accepted and dropped, so the
+ * replayed session must issue the same commands as the recorded one (same Start() arguments).
+ *
+ * RealTime paces transfers on the kernel clock by their recorded spacing; AsFastAsPossible
+ * returns them back to back on a virtual clock that follows the recorded timestamps, so sensor
+ * timestamps (and everything resampled from them) are identical run to run.
+ */
+class ShtpReplay
+{
+public:
+    enum class Pace : uint8_t { RealTime, AsFastAsPossible };
+
+    ShtpReplay(const uint8_t *capture, size_t len, Pace pace);
+
+    sh2_Hal_t *Hal() { return &mHal; }
+
+    bool Valid() const { return mValid; }
+    bool Finished() const { return mOffset >= mLength; }
+    uint32_t Transfers() const { return mTransfers; }
+
+private:
+    static int Open(sh2_Hal_t *self);
+    static void Close(sh2_Hal_t *self);
+    static int Read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us);
+    static int Write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len);
+    static uint32_t GetTimeUs(sh2_Hal_t *self);
+
+    uint32_t Now() const;
+    bool NextInbound();
+
+    sh2_Hal_t       mHal;           /**< first member: the HAL callbacks cast self back */
+    const uint8_t*  mCapture;
+    size_t          mLength;
+    Pace            mPace;
+    bool            mValid = false;
+    size_t          mOffset = 0;
+    uint32_t        mFirstUs = 0;   /**< recorded time of the first record */
+    uint32_t        mStartUs = 0;   /**< kernel time the replay was opened at */
+    uint32_t        mVirtualUs = 0;
+    uint32_t        mTransfers = 0;
+};
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <hal/RingBuffer.hpp>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/spinlock.h>
 
 namespace arduino {
 
@@ -63,7 +65,49 @@ public:
   virtual void flush();
   virtual int available();
 
+  /**
+   * Async transactions. Messages point straight at the caller's buffers (no txBuffer /
+   * rxRingBuffer copies), are queued and run back to back, and complete through cb:
+   * from the driver's completion interrupt with CONFIG_I2C_CALLBACK, otherwise from a
+   * work item doing the blocking transfer. Buffers must stay valid until cb runs.
+   * Return 0 when queued, -ENOBUFS when cQueueDepth transactions are already pending.
+   */
+  using TransferCallback = void (*)(int result, void *user);
+  static constexpr size_t cMaxMsgs = 2;
+  static constexpr size_t cQueueDepth = 8;
+
+  int transferAsync(uint8_t address, struct i2c_msg *msgs, uint8_t num, TransferCallback cb, void *user);
+  int readAsync(uint8_t address, uint8_t *rx, size_t len, TransferCallback cb, void *user);
+  int writeAsync(uint8_t address, const uint8_t *tx, size_t len, TransferCallback cb, void *user);
+  int writeReadAsync(uint8_t address, const uint8_t *tx, size_t txLen, uint8_t *rx, size_t rxLen,
+                     TransferCallback cb, void *user);
+
 private:
+  struct Transaction {
+    struct i2c_msg msgs[cMaxMsgs];
+    uint8_t num;
+    uint8_t address;
+    TransferCallback cb;
+    void *user;
+  };
+  struct AsyncWork {
+    struct k_work work;
+    ZephyrI2C *owner;
+  };
+
+  void startNext();
+  void complete(int result);
+  static void onTransferDone(const struct device *dev, int result, void *data);
+  static void onWork(struct k_work *work);
+
+  Transaction asyncQueue[cQueueDepth];
+  uint8_t asyncHead = 0;
+  uint8_t asyncCount = 0;
+  bool asyncBusy = false;
+  bool asyncInit = false;
+  struct k_spinlock asyncLock;
+  AsyncWork asyncWork;
+
   int _address;
   uint8_t txBuffer[256];
   uint32_t usedTxBuffer;
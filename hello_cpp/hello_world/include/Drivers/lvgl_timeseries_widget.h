@@ -0,0 +1,84 @@
+/* ===================== lvgl_timeseries_widget.h ===================== */
+
+#ifndef LVGL_TIMESERIES_WIDGET_H
+#define LVGL_TIMESERIES_WIDGET_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <lvgl.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TS_WIDGET_MAX_CHANNELS 4
+#define TS_WIDGET_MAX_COLUMNS 128 /* one column per display pixel */
+#define TS_WIDGET_PENDING 8       /* finished columns waiting for the GUI timer */
+
+/* Widget configuration, copied at init */
+struct ts_widget_cfg {
+    lv_coord_t width;
+    lv_coord_t height;
+    uint16_t columns;         /* <= TS_WIDGET_MAX_COLUMNS */
+    uint32_t samples_per_col; /* e.g. 153 Hz * 4 s / 128 px ~= 5 */
+    int32_t y_min;
+    int32_t y_max;
+    bool autoscale;           /* widen y range when a column falls outside it */
+    uint32_t refresh_ms;      /* GUI timer period that drains finished columns */
+};
+
+/* One min/max bucket: everything a column has to draw */
+struct ts_bucket {
+    int32_t min;
+    int32_t max;
+};
+
+struct ts_channel {
+    lv_chart_series_t *series;
+    struct ts_bucket acc;  /* column being filled */
+    uint32_t acc_count;
+    struct ts_bucket pending[TS_WIDGET_PENDING];
+    uint8_t pending_head;
+    uint8_t pending_count;
+    uint32_t overruns;     /* columns dropped because the GUI fell behind */
+};
+
+/* Instance storage, owned by the caller */
+struct ts_widget {
+    struct ts_widget_cfg cfg;
+    lv_obj_t *chart;
+    lv_timer_t *timer;
+    uint8_t channel_count;
+    struct ts_channel ch[TS_WIDGET_MAX_CHANNELS];
+    struct k_spinlock lock;
+};
+
+/* Public API */
+int ts_widget_init(struct ts_widget *w, lv_obj_t *parent, const struct ts_widget_cfg *cfg);
+/* returns the channel index, or -ENOMEM */
+int ts_widget_add_channel(struct ts_widget *w, lv_color_t color);
+/* O(1), no raw history; callable from any thread or ISR */
+void ts_widget_add_sample(struct ts_widget *w, uint8_t channel, int32_t value);
+void ts_widget_add_samples(struct ts_widget *w, uint8_t channel, const int32_t *values, size_t n);
+
+/*
+ * Usage (153 Hz IMU roll, 4 s across a 128 px chart):
+ *
+ *   static struct ts_widget imu_plot;
+ *   static const struct ts_widget_cfg cfg = {
+ *       .width = 128, .height = 64, .columns = 128, .samples_per_col = 5,
+ *       .y_min = -180, .y_max = 180, .refresh_ms = 100,
+ *   };
+ *   ts_widget_init(&imu_plot, parent, &cfg);
+ *   int roll = ts_widget_add_channel(&imu_plot, lv_palette_main(LV_PALETTE_BLUE));
+ *   ...
+ *   ts_widget_add_sample(&imu_plot, roll, (int32_t)roll_deg);   // sensor thread
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LVGL_TIMESERIES_WIDGET_H */
@@ -0,0 +1,54 @@
+#ifndef SERVICE_ACQUISITION__H_H
+#define SERVICE_ACQUISITION__H_H
+#include <ActiveObject.hpp>
+#include <Services/Pipeline.hpp>
+#include <cstddef>
+
+/**
+ * Customize the static methods of an RTOS::ActiveObject
+ */
+namespace Service
+{
+    /**
+     * First pipeline stage: fills System::mWindows slots frame by frame, in place, and hands
+     * each whole window to Service::Dsp. Owns the BNO085Stream on boards that wire H_INTN:
+     * the interrupt starts the transfer's I2C reads in the background and their completion
+     * wakes this service, which hands them to sh2 at the highest application priority. Never waits on the stages behind it: with no free slot the window just filled
+     * is dropped (Stats().dropped) and refilled.
+     */
+    class Acquisition : public RTOS::ActiveObject<Acquisition>
+    {
+    public:
+        /** Only the pipeline's wake-ups in the input queue, no channel forwards to purge them */
+        static constexpr bool cForwardsChannels = false;
+
+        static void Initialize();
+        static void Handle(const uint8_t arg[]);
+        static void End(){
+        };
+
+        /**
+         * Room left in the window being filled, for one producer: this service's thread, or the
+         * single thread running a BNO085Stream replay when there is no hub.
+         * @param frames set to the number of whole frames free at the returned pointer
+         */
+        static float* Reserve(size_t& frames);
+
+        /** Marks frames written at Reserve(); hands the window over once it is full. */
+        static void Commit(size_t frames);
+
+        /**
+         * Called with every batch of frames Commit() accepts, on the producer's thread, before
+         * the window is handed over; must not block. One tap, nullptr removes it.
+         */
+        static void Tap(void (*tap)(const float* frames, size_t count));
+
+        static const Pipeline::StageStats& Stats();
+
+        constexpr Acquisition() : RTOS::ActiveObject<Acquisition>(){};
+    private:
+        static void Drain();
+    };
+
+}
+#endif
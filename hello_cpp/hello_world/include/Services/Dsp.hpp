@@ -0,0 +1,39 @@
+#ifndef SERVICE_DSP__H_H
+#define SERVICE_DSP__H_H
+#include <ActiveObject.hpp>
+#include <Services/Pipeline.hpp>
+
+/**
+ * Customize the static methods of an RTOS::ActiveObject
+ */
+namespace Service
+{
+    /**
+     * Second pipeline stage: takes whole windows from System::mWindows, runs the impulse's DSP
+     * block on them (EImpulse::Extract()) straight into a System::mFeatures slot and hands that
+     * to Service::Inference. A window stays queued while the NN side holds every feature slot;
+     * Service::Inference wakes this stage again when it releases one.
+     */
+    class Dsp : public RTOS::ActiveObject<Dsp>
+    {
+    public:
+        /** Only the pipeline's wake-ups in the input queue, no channel forwards to purge them */
+        static constexpr bool cForwardsChannels = false;
+
+        static void Initialize();
+        static void Handle(const uint8_t arg[]);
+        static void End(){
+        };
+
+        /** Wakes the stage; never blocks, callable from any thread. */
+        static void Wake();
+
+        static const Pipeline::StageStats& Stats();
+
+        constexpr Dsp() : RTOS::ActiveObject<Dsp>(){};
+    private:
+        static void Extract();
+    };
+
+}
+#endif
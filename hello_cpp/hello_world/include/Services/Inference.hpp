@@ -0,0 +1,56 @@
+#ifndef SERVICE_INFERENCE__H_H
+#define SERVICE_INFERENCE__H_H
+#include <ActiveObject.hpp>
+#include <Services/Pipeline.hpp>
+
+/**
+ * One classified window, published on inference_chan.
+ */
+struct inference_msg {
+	uint32_t	window;				/**< sequence number of the window */
+	int32_t		error;				/**< EI_IMPULSE_ERROR; label and scores only valid when 0 */
+	uint8_t		label;				/**< best scoring label, see EImpulse::Label() */
+	float		scores[EImpulse::cLabelCount];
+	uint32_t	dsp_us;				/**< Service::Dsp time on the window */
+	uint32_t	classification_us;
+	uint32_t	latency_us;			/**< from the window's last frame to this message */
+};
+
+ZBUS_CHAN_DECLARE(inference_chan);
+
+/**
+ * Customize the static methods of an RTOS::ActiveObject
+ */
+namespace Service
+{
+    /**
+     * Last pipeline stage: classifies every feature vector in System::mFeatures
+     * (EImpulse::Classify()) and publishes an inference_msg per window on inference_chan.
+     * Runs below Service::Dsp, which in turn runs below Service::Acquisition, so the next
+     * window's DSP preempts the NN and a slow model never holds up the sensor. Logs the
+     * per-stage occupancy and latency every few windows.
+     */
+    class Inference : public RTOS::ActiveObject<Inference>
+    {
+    public:
+        /** Only the pipeline's wake-ups in the input queue, no channel forwards to purge them */
+        static constexpr bool cForwardsChannels = false;
+
+        static void Initialize();
+        static void Handle(const uint8_t arg[]);
+        static void End(){
+        };
+
+        /** Wakes the stage; never blocks, callable from any thread. */
+        static void Wake();
+
+        static const Pipeline::StageStats& Stats();
+
+        constexpr Inference() : RTOS::ActiveObject<Inference>(){};
+    private:
+        static void Classify();
+        static void Report();
+    };
+
+}
+#endif
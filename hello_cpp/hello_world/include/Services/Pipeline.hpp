@@ -0,0 +1,65 @@
+#ifndef SERVICE_PIPELINE__H_H
+#define SERVICE_PIPELINE__H_H
+#include <Drivers/EdgeImpulse.hpp>
+#include <hal/Handoff.hpp>
+#include <cstdint>
+
+/**
+ * Classification pipeline, one ActiveObject per stage:
+ *
+ *   Service::Acquisition --System::mWindows--> Service::Dsp --System::mFeatures--> Service::Inference
+ *
+ * Acquisition fills window A in place while the DSP works on window B and the NN on the features
+ * of the window before. Windows and feature vectors are double buffered RTOS::Handoff slots: a
+ * stage hands its output over by pointer, and the ActiveObject message that follows is only a
+ * wake-up. Those queues purge when full, so a wake-up may get lost but a buffer never does:
+ * every stage drains all of its input on each wake-up, and a stage whose output is full wakes
+ * the stage after it again, so a lost wake-up costs at most one window. The stages take no
+ * channel forwards (cForwardsChannels = false), their queues only ever hold these wake-ups.
+ */
+namespace Pipeline
+{
+    enum Stage : uint8_t { Acquisition = 0, Dsp, Nn, StageCount };
+
+    struct Window {
+        float       data[EImpulse::cWindowFloats];
+        uint32_t    seq;
+        uint32_t    completedAt;            /**< cycle count when the last frame landed */
+    };
+
+    struct Features {
+        EImpulse::Feature data[EImpulse::cFeatureCount];
+        uint32_t    seq;                    /**< of the window they come from */
+        uint32_t    completedAt;
+        uint32_t    dspUs;
+        int32_t     error;                  /**< EI_IMPULSE_ERROR of the DSP stage */
+    };
+
+    /**
+     * Counters of one stage, written by that stage's thread only and read by anyone.
+     * busyUs wraps: take two snapshots, occupancy = (busy1 - busy0) / elapsed.
+     */
+    struct StageStats {
+        uint32_t    items;                  /**< windows that left the stage */
+        uint32_t    busyUs;                 /**< time spent working */
+        uint32_t    lastUs;                 /**< latency of the last window through the stage */
+        uint32_t    maxUs;
+        uint32_t    waitUsMax;              /**< longest the stage's input sat before it was served */
+        uint32_t    dropped;                /**< windows lost at the stage's input */
+
+        inline void Busy(uint32_t us) { busyUs += us; }
+
+        inline void Waited(uint32_t us) { waitUsMax = (us > waitUsMax) ? us : waitUsMax; }
+
+        inline void Record(uint32_t us)
+        {
+            items++;
+            lastUs = us;
+            maxUs = (us > maxUs) ? us : maxUs;
+        }
+    };
+
+    using Windows = RTOS::Handoff<Window, 2>;
+    using FeatureVectors = RTOS::Handoff<Features, 2>;
+}
+#endif
@@ -4,14 +4,18 @@
 #include <vector>
 #include <Services/LoRa.hpp>
 #include <Services/HardwareTimers.hpp>
-#include <hal/RingBuffer.hpp>
+#include <Services/Acquisition.hpp>
+#include <Services/Dsp.hpp>
+#include <Services/Inference.hpp>
+#include <Services/Pipeline.hpp>
 #include <Utils/overload.hpp>
 
 class System {
-#define _REGISTERED_SERVICES    std::monostate, Service::LoRa,      Service::HardwareTimers
-#define REGISTERED_SERVICES     Service::LoRa{},     Service::HardwareTimers{}
+#define _REGISTERED_SERVICES    std::monostate, Service::LoRa,      Service::HardwareTimers,     Service::Acquisition,     Service::Dsp,     Service::Inference
+#define REGISTERED_SERVICES     Service::LoRa{},     Service::HardwareTimers{},     Service::Acquisition{},     Service::Dsp{},     Service::Inference{}
 public:
-	static RTOS::HAL::RingBuffer<float,153*16> mDSPDataRingBuffer;
+	static Pipeline::Windows mWindows;			/**< Service::Acquisition -> Service::Dsp */
+	static Pipeline::FeatureVectors mFeatures;	/**< Service::Dsp -> Service::Inference */
     static std::vector<std::variant<_REGISTERED_SERVICES>> mSystemServicesRegistered;
 public:
 	constexpr System() {};	
@@ -58,6 +62,18 @@ public:
 								while(1){RTOS::Hal::Delay(1000);};
                             // LOG_INF("Initializing: %s", x.mName);
                             // LOG_INF("Address a pointer at = 0x%08x", (unsigned int)&x);
+                        },
+                        [](const Service::Acquisition &x)
+                        {
+                            // LOG_INF("Initializing: %s", x.mName);
+                        },
+                        [](const Service::Dsp &x)
+                        {
+                            // LOG_INF("Initializing: %s", x.mName);
+                        },
+                        [](const Service::Inference &x)
+                        {
+                            // LOG_INF("Initializing: %s", x.mName);
                         }
                         
                     },
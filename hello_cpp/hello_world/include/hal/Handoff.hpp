@@ -0,0 +1,102 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace RTOS {
+
+/**
+ * Fixed set of buffers passed between two pipeline stages by ownership, never by copy.
+ * A slot belongs to exactly one side at a time: the producer Acquire()s a free one, fills it in
+ * place and Submit()s it; the consumer Take()s it, works on it in place and Release()s it.
+ * Only the slot pointer travels, through a msgq sized for every slot, so Submit() cannot fail
+ * and nothing is ever purged. With T_Count = 2 this is double buffering: one slot being
+ * filled while the other one is processed.
+ *
+ * Nothing here blocks. A producer that finds no free slot decides itself what to drop
+ * (sampling keeps overwriting its current slot rather than wait for the consumer).
+ */
+template <typename T, size_t T_Count = 2>
+class Handoff {
+    static_assert(T_Count >= 2 && T_Count <= 32, "one free bit per slot in an atomic_t");
+
+public:
+    Handoff()
+    {
+        k_msgq_init(&mReady, mReadyBuffer, sizeof(T*), T_Count);
+    }
+
+    /**
+     * Producer: takes a free slot to fill.
+     * @return nullptr while the consumer side still holds every slot.
+     */
+    T* Acquire()
+    {
+        atomic_val_t free;
+        size_t ix;
+
+        do {
+            free = atomic_get(&mFree);
+            if (free == 0) {
+                return nullptr;
+            }
+            ix = find_lsb_set(free) - 1;
+        } while (!atomic_cas(&mFree, free, free & ~BIT(ix)));
+
+        return &mSlots[ix];
+    }
+
+    /** Producer: hands a filled slot to the consumer, oldest first. */
+    void Submit(T* slot)
+    {
+        mSubmittedAt[Index(slot)] = k_cycle_get_32();
+        k_msgq_put(&mReady, &slot, K_NO_WAIT);
+    }
+
+    /**
+     * Consumer: oldest submitted slot, nullptr when none is waiting.
+     * @param waitUs how long the slot sat between Submit() and Take()
+     */
+    T* Take(uint32_t* waitUs = nullptr)
+    {
+        T* slot = nullptr;
+
+        if (k_msgq_get(&mReady, &slot, K_NO_WAIT) != 0) {
+            return nullptr;
+        }
+        if (waitUs != nullptr) {
+            *waitUs = k_cyc_to_us_floor32(k_cycle_get_32() - mSubmittedAt[Index(slot)]);
+        }
+        return slot;
+    }
+
+    /** Consumer: gives the slot back to the producer. */
+    void Release(T* slot)
+    {
+        atomic_or(&mFree, BIT(Index(slot)));
+    }
+
+    /** Slots submitted and not taken yet */
+    inline size_t Ready() { return k_msgq_num_used_get(&mReady); }
+
+    /** Slots held by either side or queued between them, out of Capacity() */
+    inline size_t InUse() const { return T_Count - __builtin_popcount((uint32_t)atomic_get(&mFree)); }
+
+    static constexpr size_t Capacity() { return T_Count; }
+
+private:
+    static constexpr atomic_val_t cAllFree = BIT_MASK(T_Count);
+
+    inline size_t Index(const T* slot) const { return (size_t)(slot - mSlots); }
+
+    T                   mSlots[T_Count]{};
+    atomic_t            mFree = ATOMIC_INIT(cAllFree);
+    uint32_t            mSubmittedAt[T_Count]{};    /**< cycle count at Submit() */
+    struct k_msgq       mReady{};
+    alignas(T*) char    mReadyBuffer[T_Count * sizeof(T*)]{};
+};
+
+} // namespace RTOS
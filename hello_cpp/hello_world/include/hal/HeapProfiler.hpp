@@ -0,0 +1,81 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/heap_listener.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace RTOS {
+
+/**
+ * Heap profiler built on the sys_heap listeners.
+ * Every allocation on an attached heap is booked against its call site in fixed tables:
+ * live bytes, peak, alloc/free counts and how scattered the site's live blocks are.
+ * Nothing is logged per allocation; Dump() prints the per-site view on demand.
+ *
+ * A call site is the first cFrames return addresses above the allocator, taken with
+ * arch_stack_walk() (CONFIG_ARCH_STACKWALK, plus CONFIG_FRAME_POINTER on RISC-V). The
+ * allocator's own frames (sys_heap, k_heap, k_malloc, malloc and friends, the listener)
+ * differ per arch and config, so Attach() and AttachMalloc() learn them: they allocate once
+ * through every entry point from a known probe function and remember each return address
+ * below it. Without stack walking, sites collapse to the allocating thread. Resolve the
+ * printed addresses with addr2line on zephyr.elf.
+ */
+class HeapProfiler {
+public:
+    static constexpr size_t cMaxHeaps = 2;
+    static constexpr size_t cMaxSites = 24;
+    static constexpr size_t cMaxBlocks = 96;
+    static constexpr size_t cFrames = 4;
+    static constexpr size_t cWalkFrames = 20;       /**< deepest walk: allocator chain + cFrames */
+    static constexpr size_t cAllocatorFrames = 24;  /**< learnt allocator return addresses */
+
+    struct Site {
+        uintptr_t frames[cFrames];
+        const struct k_thread *thread;
+        size_t liveBytes;
+        size_t peakBytes;
+        uint32_t liveBlocks;
+        uint32_t allocs;
+        uint32_t frees;
+    };
+
+    /**
+     * Registers the alloc/free listeners for a heap, e.g. &_system_heap, and learns the
+     * allocator frames with a few one byte allocations from it (k_malloc() and friends too
+     * for the system heap).
+     * @return false when all cMaxHeaps slots are used.
+     */
+    static bool Attach(struct k_heap *heap);
+
+    /**
+     * Registers the alloc/free listeners for a bare sys_heap. Its allocator frames are not
+     * learnt (there is no lock to allocate under), so sites start inside its allocator.
+     * @return false when all cMaxHeaps slots are used.
+     */
+    static bool Attach(struct sys_heap *heap);
+
+    /**
+     * Attaches the libc malloc arena (CONFIG_COMMON_LIBC_MALLOC_ARENA_SIZE), a sys_heap of its
+     * own that malloc(), operator new, std::vector and ei_malloc() allocate from, and learns
+     * the malloc() family's and operator new's frames. The arena is static in libc, so it is
+     * found among the heaps saved by sys_heap_init(): needs CONFIG_SYS_HEAP_ARRAY_SIZE > 0.
+     * @return false without the arena or when all cMaxHeaps slots are used.
+     */
+    static bool AttachMalloc();
+
+    /** Logs one line per call site plus the attached heaps' totals. */
+    static void Dump();
+
+    /** Forgets all sites and blocks; blocks allocated before are ignored when freed. */
+    static void Reset();
+
+    /** Allocations that could not be tracked because a table was full. */
+    static uint32_t Dropped();
+
+private:
+    static void OnAlloc(uintptr_t heapId, void *mem, size_t bytes);
+    static void OnFree(uintptr_t heapId, void *mem, size_t bytes);
+};
+
+} // namespace RTOS
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace RTOS {
+
+/**
+ * Conflating "latest value" slot for state-like data (IMU pose, battery, GNSS fix).
+ * The publisher overwrites one copy under a seqlock and never waits on readers; readers
+ * take consistent snapshots and always see the newest value, intermediate ones are skipped.
+ * Wake-ups conflate too: each reader owns a binary semaphore, so a slow reader finds at
+ * most one pending wake-up, never a backlog.
+ */
+template <typename T, size_t T_MaxReaders = 4>
+class LatestValue {
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock snapshots copy T byte-wise");
+
+public:
+    struct Reader {
+        struct k_sem    wake;
+        uint32_t        seen;       /**< sequence of the last value handed out */
+    };
+
+    LatestValue() = default;
+
+    /** Registers a reader; false when all T_MaxReaders slots are taken. */
+    bool Subscribe(Reader& reader)
+    {
+        k_spinlock_key_t key = k_spin_lock(&mWriteLock);
+
+        if (mReaderCount == T_MaxReaders) {
+            k_spin_unlock(&mWriteLock, key);
+            return false;
+        }
+        k_sem_init(&reader.wake, 0, 1);
+        reader.seen = Sequence();
+        mReaders[mReaderCount++] = &reader;
+        k_spin_unlock(&mWriteLock, key);
+        return true;
+    }
+
+    /** Overwrites the value; callable from threads and ISRs, never blocks. */
+    void Publish(const T& value)
+    {
+        k_spinlock_key_t key = k_spin_lock(&mWriteLock);
+
+        atomic_inc(&mSeq);                  /* odd: write in progress */
+        barrier_dmem_fence_full();
+        mValue = value;
+        barrier_dmem_fence_full();
+        atomic_inc(&mSeq);                  /* even: stable */
+        const size_t readers = mReaderCount;
+        k_spin_unlock(&mWriteLock, key);
+
+        /* outside the lock so a woken higher priority reader can run right away;
+         * the reader table only ever grows */
+        for (size_t i = 0; i < readers; ++i) {
+            k_sem_give(&mReaders[i]->wake);
+        }
+    }
+
+    /**
+     * Consistent snapshot of the newest value.
+     * @return its sequence number, 0 when nothing was published yet.
+     */
+    uint32_t Read(T& out) const
+    {
+        uint32_t before;
+        uint32_t after;
+
+        do {
+            before = Sequence();
+            while (before & 1U) {
+                k_yield();
+                before = Sequence();
+            }
+            barrier_dmem_fence_full();
+            out = mValue;
+            barrier_dmem_fence_full();
+            after = Sequence();
+        } while (before != after);
+
+        return before / 2U;
+    }
+
+    /**
+     * Hands the reader the newest value it has not seen yet, waiting up to timeout for one.
+     * @return false on timeout.
+     */
+    bool Wait(Reader& reader, T& out, k_timeout_t timeout)
+    {
+        while (Sequence() == reader.seen) {
+            if (k_sem_take(&reader.wake, timeout) != 0) {
+                return false;
+            }
+        }
+        reader.seen = 2U * Read(out);
+        return true;
+    }
+
+private:
+    inline uint32_t Sequence() const { return (uint32_t)atomic_get(&mSeq); }
+
+    mutable atomic_t    mSeq = ATOMIC_INIT(0);
+    T                   mValue{};
+    struct k_spinlock   mWriteLock{};
+    Reader*             mReaders[T_MaxReaders]{};
+    size_t              mReaderCount = 0;
+};
+
+} // namespace RTOS
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/zbus/zbus.h>
+#include <zpp/mem_slab.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace RTOS {
+
+/**
+ * Reference counted payload living in a SharedChannel slab.
+ * The payload follows the header in the same block.
+ */
+struct SharedBlock {
+    atomic_t            refs;
+    uint32_t            length;
+    struct k_mem_slab*  slab;
+
+    inline uint8_t* Data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    inline const uint8_t* Data() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+};
+
+/**
+ * The zbus message of a shared channel: one pointer, whatever the payload size.
+ * Readers get it from SharedReader::Wait() and must call Release() once done.
+ */
+struct SharedFrame {
+    const SharedBlock*  block;
+
+    inline const uint8_t* Data() const { return block->Data(); }
+    inline size_t Length() const { return block->length; }
+
+    /** Drops one reference; the last one returns the block to its slab. */
+    inline void Release() const
+    {
+        SharedBlock* b = const_cast<SharedBlock*>(block);
+
+        if (b != nullptr && atomic_dec(&b->refs) == 1) {
+            k_mem_slab_free(b->slab, b);
+        }
+    }
+};
+
+/**
+ * Reader of a SharedChannel: a zbus listener on the channel plus a queue of handles.
+ * The listener runs in the publisher's context, while the publisher still holds its own
+ * reference, and takes one more for this reader only if the handle fits in the queue; a full
+ * queue counts a drop instead. References therefore match deliveries exactly, one observer at
+ * a time, whatever happens to the other observers of the same publication.
+ * Define with SHARED_CHANNEL_READER_DEFINE and list <name>_lis among the channel's observers.
+ */
+struct SharedReader {
+    struct k_msgq*  frames;
+    atomic_t        dropped;
+
+    /** Listener body, see SHARED_CHANNEL_READER_DEFINE */
+    inline void Deliver(const struct zbus_channel* chan)
+    {
+        const SharedFrame* frame = static_cast<const SharedFrame*>(zbus_chan_const_msg(chan));
+        SharedBlock* b = const_cast<SharedBlock*>(frame->block);
+
+        if (b == nullptr) {
+            return;
+        }
+        atomic_inc(&b->refs);
+        if (k_msgq_put(frames, frame, K_NO_WAIT) != 0) {
+            atomic_dec(&b->refs);
+            atomic_inc(&dropped);
+        }
+    }
+
+    /** Next handle, waiting up to timeout; the caller owns one reference on success. */
+    inline bool Wait(SharedFrame& frame, k_timeout_t timeout)
+    {
+        return k_msgq_get(frames, &frame, timeout) == 0;
+    }
+
+    /** Frames lost because this reader's queue was full */
+    inline uint32_t Dropped() const { return (uint32_t)atomic_get(&dropped); }
+};
+
+/**
+ * Defines SharedReader _name, its _depth deep handle queue and its zbus listener _name##_lis.
+ * The listener is the registration: put it in the channel's ZBUS_OBSERVERS() (or add it
+ * with zbus_chan_add_obs()) and the reader gets every frame published after that.
+ */
+#define SHARED_CHANNEL_READER_DEFINE(_name, _depth)                                             \
+    K_MSGQ_DEFINE(_name##_frames, sizeof(RTOS::SharedFrame), _depth, sizeof(void *));           \
+    static RTOS::SharedReader _name = {.frames = &_name##_frames, .dropped = ATOMIC_INIT(0)};    \
+    static void _name##_deliver(const struct zbus_channel *chan) { _name.Deliver(chan); }       \
+    ZBUS_LISTENER_DEFINE(_name##_lis, _name##_deliver)
+
+/**
+ * Multicast channel for large payloads (IMU windows, feature vectors).
+ * The publisher writes once into a slab block and zbus only carries a SharedFrame,
+ * so fan-out to N readers costs N pointer copies instead of N payload copies.
+ *
+ * Readers are SharedReaders (zbus listeners that take their own reference). Plain zbus
+ * subscribers and msg subscribers must not be attached, nor zbus_chan_read() the channel:
+ * they would get the handle without a reference and read it after the block went back to
+ * the slab. Other listeners may look at the frame during their callback.
+ */
+template <uint32_t T_PayloadSize, uint32_t T_BlockCount>
+class SharedChannel {
+public:
+    static constexpr uint32_t cBlockSize = ROUND_UP(sizeof(SharedBlock) + T_PayloadSize, sizeof(void*));
+
+    explicit SharedChannel(const struct zbus_channel* chan) : mChan(chan) {}
+
+    /**
+     * Takes a free block to write into; the publisher holds its only reference.
+     * @return nullptr when the slab stayed empty for the whole timeout.
+     */
+    SharedBlock* Acquire(k_timeout_t timeout)
+    {
+        void* mem = nullptr;
+
+        if (k_mem_slab_alloc(mSlab.native_handle(), &mem, timeout) != 0) {
+            return nullptr;
+        }
+
+        SharedBlock* block = static_cast<SharedBlock*>(mem);
+
+        atomic_set(&block->refs, 1);
+        block->length = 0;
+        block->slab = mSlab.native_handle();
+        return block;
+    }
+
+    /**
+     * Hands the block to every reader and drops the publisher's reference.
+     * Each SharedReader's listener took its own reference if it queued the handle, so on
+     * any error (channel busy, a reader's queue full) only the frames actually delivered stay
+     * alive, and with no delivery at all the block is freed here.
+     */
+    int Publish(SharedBlock* block, size_t length, k_timeout_t timeout)
+    {
+        const SharedFrame frame = {.block = block};
+
+        block->length = MIN(length, T_PayloadSize);
+
+        int err = zbus_chan_pub(mChan, &frame, timeout);
+
+        frame.Release();
+        return err;
+    }
+
+    inline size_t Capacity() const { return T_PayloadSize; }
+    inline uint32_t UsedBlocks() { return mSlab.used_block_count(); }
+
+private:
+    const struct zbus_channel*              mChan;
+    zpp::mem_slab<cBlockSize, T_BlockCount> mSlab;
+};
+
+} // namespace RTOS
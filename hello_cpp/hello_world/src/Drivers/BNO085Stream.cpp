@@ -0,0 +1,218 @@
+#include <Drivers/BNO085Stream.hpp>
+#include <Services/Acquisition.hpp>
+#include <model-parameters/model_metadata.h>
+
+#define LOG_LEVEL 3
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(BNO085Stream);
+
+// Built on boards that wire H_INTN (bno085-int-gpios in the zephyr,user node) only: the sh2/SHTP
+// sources, BNO085.cpp and the Wire object come from the board's Arduino core and are not in this
+// tree, so native_sim has nothing to link StartReplay()/RunReplay() against
+#if BNO085_HAS_INT
+
+// One hub per system; the GPIO and sh2 callbacks only carry a C cookie
+static BNO085Stream* sInstance = nullptr;
+
+bool BNO085Stream::_init(int32_t sensor_id)
+{
+    // Recorder last: it records what the async HAL hands to sh2
+    mAsync.Wrap(_HAL, OnTransfer);
+    if (mRecorder != nullptr) {
+        mRecorder->Wrap(_HAL);
+    }
+    if (!BNO085::_init(sensor_id)) {
+        return false;
+    }
+    // Replace the polling callback (which copies into sensorValue) with the block decoder
+    return sh2_setSensorCallback(OnSensorEvent, this) == SH2_OK;
+}
+
+bool BNO085Stream::Configure(const uint8_t* axes, size_t axesCount, uint32_t rateHz)
+{
+    ImuReportScheduler::Report reports[ImuReportScheduler::cMaxReports];
+    const uint32_t features = ImuReportScheduler::FeaturesFromFusion(EI_CLASSIFIER_FUSION_AXES_STRING, axes, axesCount);
+    const size_t count = mScheduler.Plan(features, rateHz, reports);
+
+    if (count == 0) {
+        LOG_ERR("No report to enable at %u Hz", rateHz);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!enableReport(reports[i].id, reports[i].intervalUs)) {
+            LOG_ERR("Could not enable report 0x%02x", reports[i].id);
+            return false;
+        }
+        LOG_INF("%s: report 0x%02x every %u us", __FUNCTION__, reports[i].id, reports[i].intervalUs);
+    }
+    return true;
+}
+
+bool BNO085Stream::StartReplay(ShtpReplay& replay, const uint8_t* axes, size_t axesCount, uint32_t rateHz)
+{
+    if (axesCount != EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME || !replay.Valid()) {
+        LOG_ERR("Bad replay setup");
+        return false;
+    }
+    mFrontEnd = QuaternionFrontEnd(axes, axesCount);
+    sInstance = this;
+    mBlock.count = 0;
+
+    if (sh2_open(replay.Hal(), OnHubEvent, this) != SH2_OK ||
+        sh2_setSensorCallback(OnSensorEvent, this) != SH2_OK) {
+        LOG_ERR("Capture does not open");
+        return false;
+    }
+    return Configure(axes, axesCount, rateHz);
+}
+
+uint32_t BNO085Stream::RunReplay(ShtpReplay& replay)
+{
+    const uint32_t frames = mFrames;
+    const uint32_t start = k_cycle_get_32();
+
+    while (!replay.Finished()) {
+        sh2_service();
+    }
+    Flush();
+
+    const uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    const uint32_t produced = mFrames - frames;
+
+    LOG_INF("%s: %u transfers -> %u frames (%u ticks skipped) in %u us, %u frames/s",
+            __FUNCTION__, replay.Transfers(), produced, SkippedTicks(), us,
+            (us > 0) ? (uint32_t)((uint64_t)produced * 1000000U / us) : 0);
+    return produced;
+}
+
+void BNO085Stream::OnHubEvent(void *cookie, sh2_AsyncEvent_t *event)
+{
+    ARG_UNUSED(cookie);
+
+    if (event->eventId == SH2_RESET) {
+        LOG_INF("Hub reset");
+    }
+}
+
+void BNO085Stream::OnTransfer()
+{
+    if (sInstance->mNotify != nullptr) {
+        sInstance->mNotify();
+    }
+}
+
+static const struct gpio_dt_spec sIntGpio = GPIO_DT_SPEC_GET(DT_PATH(zephyr_user), bno085_int_gpios);
+
+bool BNO085Stream::Start(const uint8_t* axes, size_t axesCount, uint32_t rateHz)
+{
+    if (axesCount != EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME) {
+        LOG_ERR("%zu axes selected, frames are %u wide", axesCount, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+        return false;
+    }
+    mFrontEnd = QuaternionFrontEnd(axes, axesCount);
+
+    sInstance = this;
+    mBlock.count = 0;
+
+    if (!begin()) {
+        LOG_ERR("BNO085 not found");
+        return false;
+    }
+    if (!Configure(axes, axesCount, rateHz)) {
+        return false;
+    }
+
+    if (!gpio_is_ready_dt(&sIntGpio) ||
+        gpio_pin_configure_dt(&sIntGpio, GPIO_INPUT) != 0 ||
+        gpio_pin_interrupt_configure_dt(&sIntGpio, GPIO_INT_EDGE_TO_ACTIVE) != 0) {
+        LOG_ERR("H_INTN not usable");
+        return false;
+    }
+    gpio_init_callback(&mIntCallback, OnInterrupt, BIT(sIntGpio.pin));
+    gpio_add_callback(sIntGpio.port, &mIntCallback);
+
+    LOG_INF("%s: %u Hz grid, INT driven", __FUNCTION__, rateHz);
+    return true;
+}
+
+void BNO085Stream::OnInterrupt(const struct device *port, struct gpio_callback *cb, uint32_t pins)
+{
+    ARG_UNUSED(port);
+    ARG_UNUSED(cb);
+    ARG_UNUSED(pins);
+
+    // Only queues the transfer's reads; the completion wakes the ingestion thread
+    sInstance->mAsync.Kick();
+}
+
+
+bool BNO085Stream::Asserted() const
+{
+    return gpio_pin_get_dt(&sIntGpio) > 0;
+}
+
+void BNO085Stream::Drain()
+{
+    // One sh2_service() per transfer already read; it returns without touching the bus
+    while (mAsync.Ready()) {
+        sh2_service();
+    }
+
+    // More queued on the hub: read the next one in the background, its completion wakes us.
+    // Flush once the burst is over, full blocks go out from OnGridSample() meanwhile.
+    if (Asserted()) {
+        mAsync.Kick();
+    } else {
+        Flush();
+    }
+}
+
+void BNO085Stream::OnSensorEvent(void *cookie, sh2_SensorEvent_t *event)
+{
+    BNO085Stream* self = static_cast<BNO085Stream*>(cookie);
+    sh2_SensorValue_t value;
+
+    if (sh2_decodeSensorEvent(&value, event) != SH2_OK) {
+        return;
+    }
+    self->mScheduler.Push(value, OnGridSample, self);
+}
+
+void BNO085Stream::OnGridSample(const ImuReportScheduler::Sample& sample, void* user)
+{
+    BNO085Stream* self = static_cast<BNO085Stream*>(user);
+    ImuBlock<cBlockFrames>& b = self->mBlock;
+    const size_t n = b.count;
+
+    b.t_us[n] = sample.t_us;
+    b.qi[n] = sample.q[0];
+    b.qj[n] = sample.q[1];
+    b.qk[n] = sample.q[2];
+    b.qr[n] = sample.q[3];
+
+    if (++b.count == cBlockFrames) {
+        self->Flush();
+    }
+}
+
+void BNO085Stream::Flush()
+{
+    const ImuBlock<cBlockFrames>& b = mBlock;
+    size_t done = 0;
+
+    // Convert straight into the window being filled; a block may straddle two windows
+    while (done < b.count) {
+        size_t room = 0;
+        float* frames = Service::Acquisition::Reserve(room);
+        const size_t n = MIN(room, b.count - done);
+
+        mFrontEnd.Convert(b.qi + done, b.qj + done, b.qk + done, b.qr + done, n, frames);
+        Service::Acquisition::Commit(n);
+        done += n;
+    }
+    mFrames += b.count;
+    mBlock.count = 0;
+}
+
+#endif /* BNO085_HAS_INT */
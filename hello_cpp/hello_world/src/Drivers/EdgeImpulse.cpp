@@ -0,0 +1,264 @@
+#include <Drivers/EdgeImpulse.hpp>
+#include <edge-impulse-sdk/classifier/ei_run_classifier.h>
+#include <edge-impulse-sdk/dsp/numpy.hpp>
+
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+
+namespace {
+    constexpr size_t cMaxLearningBlocks = 4;
+
+#if EIMPULSE_INT8_FEATURES
+    // The input tensor's quantization, read by Init(): Extract() runs on another thread than
+    // Classify() and must not touch the model
+    struct InputQuantization {
+        float scale;
+        int32_t zeroPoint;
+        bool ready;
+    };
+    InputQuantization sInput = {};
+    // Float features of DSP blocks without an int8 path, quantized after (Extract() only)
+    float sFloatFeatures[EImpulse::cFeatureCount];
+
+    // A single quantized EON NN, the only learning block Classify() can feed int8 features to
+    bool IsInt8Nn(const ei_impulse_t* impulse)
+    {
+        if (impulse->learning_blocks_size != 1 || impulse->has_anomaly ||
+                impulse->learning_blocks[0].infer_fn != run_nn_inference) {
+            return false;
+        }
+        auto* config = static_cast<ei_learning_block_config_tflite_graph_t*>(impulse->learning_blocks[0].config);
+        return config->quantized == 1;
+    }
+#endif
+}
+
+// The SDK's Zephyr porting reads ei_getchar() from this UART; nothing here calls it
+const struct device *uart = DEVICE_DT_GET_OR_NULL(DT_CHOSEN(zephyr_console));
+
+void EImpulse::Init()
+{
+    run_classifier_init();
+
+#if EIMPULSE_INT8_FEATURES
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+
+    if (!IsInt8Nn(impulse)) {
+        return;
+    }
+
+    auto* config = static_cast<ei_learning_block_config_tflite_graph_t*>(impulse->learning_blocks[0].config);
+    auto* graph = static_cast<ei_config_tflite_eon_graph_t*>(config->graph_config);
+    uint64_t ctxStartUs;
+    TfLiteTensor input, output, outputLabels, outputScores;
+    ei_unique_ptr_t arena(nullptr, ei_aligned_free);
+
+    if (inference_tflite_setup(config, &ctxStartUs, &input, &output, &outputLabels, &outputScores, arena) != EI_IMPULSE_OK) {
+        return;
+    }
+    if (input.type == kTfLiteInt8) {
+        sInput = {input.params.scale, input.params.zero_point, true};
+    }
+    graph->model_reset(ei_aligned_free);
+#endif
+}
+
+int EImpulse::Run(const float* window, ei_impulse_result_t& result)
+{
+    signal_t signal;
+
+    if (ei::numpy::signal_from_buffer(window, cWindowFloats, &signal) != 0) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    return run_classifier(&signal, &result, false);
+}
+
+int EImpulse::Extract(const float* window, Feature* features)
+{
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+    const ei_model_dsp_t& block = impulse->dsp_blocks[0];
+    signal_t signal;
+
+    // Stateful blocks keep their state in the impulse handle, that is run_classifier() only
+    if (impulse->dsp_blocks_size != 1 || block.factory != nullptr || block.n_output_features != cFeatureCount) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    if (ei::numpy::signal_from_buffer(window, cWindowFloats, &signal) != 0) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    SignalWithAxes swa(&signal, block.axes, block.axes_size, impulse);
+
+#if EIMPULSE_INT8_FEATURES
+    if (!sInput.ready) {
+        return EI_IMPULSE_TFLITE_ERROR;
+    }
+
+    ei::matrix_i8_t out(1, block.n_output_features, features);
+
+    // Spectral analysis quantizes on write, no float features at all
+    if (can_run_classifier_spectral_quantized(impulse, impulse->learning_blocks[0]) == EI_IMPULSE_OK) {
+        if (extract_spectral_analysis_features_quantized(swa.get_signal(), &out, block.config,
+                sInput.scale, sInput.zeroPoint, impulse->frequency) != EIDSP_OK) {
+            return EI_IMPULSE_DSP_ERROR;
+        }
+        return EI_IMPULSE_OK;
+    }
+
+    ei::matrix_t floats(1, block.n_output_features, sFloatFeatures);
+    ei::feature_sink_t sink(&out, sInput.scale, sInput.zeroPoint);
+
+    if (block.extract_fn(swa.get_signal(), &floats, block.config, impulse->frequency) != EIDSP_OK) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    for (size_t ix = 0; ix < block.n_output_features; ix++) {
+        sink.write(ix, sFloatFeatures[ix]);
+    }
+    return EI_IMPULSE_OK;
+#else
+    // The block writes straight into the caller's feature vector
+    ei::matrix_t out(1, block.n_output_features, features);
+
+    if (block.extract_fn(swa.get_signal(), &out, block.config, impulse->frequency) != EIDSP_OK) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    return EI_IMPULSE_OK;
+#endif
+}
+
+#if EIMPULSE_INT8_FEATURES
+int EImpulse::Classify(Feature* features, ei_impulse_result_t& result)
+{
+    ei_impulse_handle_t* handle = &ei_default_impulse;
+    const ei_impulse_t* impulse = handle->impulse;
+
+    if (!IsInt8Nn(impulse)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    auto* config = static_cast<ei_learning_block_config_tflite_graph_t*>(impulse->learning_blocks[0].config);
+    auto* graph = static_cast<ei_config_tflite_eon_graph_t*>(config->graph_config);
+    uint64_t ctxStartUs;
+    TfLiteTensor input, output, outputLabels, outputScores;
+    ei_unique_ptr_t arena(nullptr, ei_aligned_free);
+
+    memset(&result, 0, sizeof(ei_impulse_result_t));
+
+    EI_IMPULSE_ERROR res = inference_tflite_setup(config, &ctxStartUs, &input, &output, &outputLabels,
+        &outputScores, arena);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    if (input.type != kTfLiteInt8 || input.bytes < cFeatureCount) {
+        graph->model_reset(ei_aligned_free);
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    // Already quantized with this tensor's scale and zero point: a plain copy
+    memcpy(input.data.int8, features, cFeatureCount);
+    res = inference_tflite_run(impulse, config, ei_read_timer_us(), &output, &outputLabels, &outputScores,
+        static_cast<uint8_t*>(arena.get()), &result, false);
+    graph->model_reset(ei_aligned_free);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    return run_postprocessing(handle, &result);
+}
+#else
+int EImpulse::Classify(Feature* features, ei_impulse_result_t& result)
+{
+    ei_impulse_handle_t* handle = &ei_default_impulse;
+    const ei_impulse_t* impulse = handle->impulse;
+    const ei_model_dsp_t& block = impulse->dsp_blocks[0];
+    // the DSP block's matrix, then one (unused) slot per learning block, as process_impulse()
+    ei_feature_t fmatrix[cMaxLearningBlocks + 1] = {};
+    ei::matrix_t matrix(1, block.n_output_features, features);
+
+    if (impulse->dsp_blocks_size != 1 || impulse->learning_blocks_size > cMaxLearningBlocks) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t ix = 0; ix < impulse->learning_blocks_size; ix++) {
+        if (impulse->learning_blocks[ix].keep_output) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+    fmatrix[0].matrix = &matrix;
+    fmatrix[0].blockId = block.blockId;
+
+    memset(&result, 0, sizeof(ei_impulse_result_t));
+
+    EI_IMPULSE_ERROR res = run_inference(handle, fmatrix, &result, false);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    return run_postprocessing(handle, &result);
+}
+#endif /* EIMPULSE_INT8_FEATURES */
+
+size_t EImpulse::Best(const ei_impulse_result_t& result)
+{
+    size_t best = 0;
+
+    for (size_t ix = 1; ix < cLabelCount; ix++) {
+        if (result.classification[ix].value > result.classification[best].value) {
+            best = ix;
+        }
+    }
+    return best;
+}
+
+const char* EImpulse::Label(size_t ix)
+{
+    return ix < cLabelCount ? ei_classifier_inferencing_categories[ix] : "?";
+}
+
+const uint8_t* EImpulse::Axes()
+{
+    return ei_default_impulse.impulse->dsp_blocks[0].axes;
+}
+
+size_t EImpulse::AxesCount()
+{
+    return ei_default_impulse.impulse->dsp_blocks[0].axes_size;
+}
+
+#if SPECTRAL_ACCURACY
+namespace {
+    ei::spectral::fixed_point::accuracy_t sAccuracy = {};
+    // The block's own axes out of the raw window, as extract_spectral_analysis_features() reads them
+    float sAxesWindow[EImpulse::cWindowFloats];
+}
+
+int EImpulse::CompareFixedPoint(const float* window)
+{
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+    const ei_model_dsp_t& block = impulse->dsp_blocks[0];
+    signal_t signal;
+
+    if (block.extract_fn != &extract_spectral_analysis_features) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    if (ei::numpy::signal_from_buffer(window, cWindowFloats, &signal) != 0) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    SignalWithAxes swa(&signal, block.axes, block.axes_size, impulse);
+    signal_t* axes = swa.get_signal();
+
+    if (axes->get_data(0, axes->total_length, sAxesWindow) != 0) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    auto* config = static_cast<ei_dsp_config_spectral_analysis_t*>(block.config);
+    if (ei::spectral::fixed_point::compare_with_float(sAxesWindow, axes->total_length, config,
+            impulse->frequency, block.n_output_features, &sAccuracy) != ei::EIDSP_OK) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    return EI_IMPULSE_OK;
+}
+
+void EImpulse::PrintFixedPointAccuracy()
+{
+    ei::spectral::fixed_point::print_accuracy(&sAccuracy);
+}
+#endif /* SPECTRAL_ACCURACY */
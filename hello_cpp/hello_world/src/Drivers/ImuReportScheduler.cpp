@@ -0,0 +1,244 @@
+#include <Drivers/ImuReportScheduler.hpp>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+struct FeatureName {
+    const char* name;
+    uint32_t    feature;
+};
+
+// Axis names as Edge Impulse writes them in the fusion string
+const FeatureName cFeatureNames[] = {
+    {"roll", ImuReportScheduler::Roll},   {"pitch", ImuReportScheduler::Pitch},
+    {"yaw", ImuReportScheduler::Yaw},     {"qX", ImuReportScheduler::QX},
+    {"qY", ImuReportScheduler::QY},       {"qZ", ImuReportScheduler::QZ},
+    {"qW", ImuReportScheduler::QW},       {"accX", ImuReportScheduler::AccX},
+    {"accY", ImuReportScheduler::AccY},   {"accZ", ImuReportScheduler::AccZ},
+    {"gyrX", ImuReportScheduler::GyrX},   {"gyrY", ImuReportScheduler::GyrY},
+    {"gyrZ", ImuReportScheduler::GyrZ},
+};
+
+uint32_t FeatureByName(const char* name, size_t len)
+{
+    for (const FeatureName& f : cFeatureNames) {
+        if (strlen(f.name) == len && strncmp(f.name, name, len) == 0) {
+            return f.feature;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+uint32_t ImuReportScheduler::FeaturesFromFusion(const char* fusion, const uint8_t* axes, size_t count)
+{
+    uint32_t features = 0;
+
+    for (size_t a = 0; a < count; ++a) {
+        const char* p = fusion;
+
+        // Walk to the axes[a]-th name of "name + name + ..."
+        for (uint8_t skip = axes[a]; skip > 0 && p != nullptr; --skip) {
+            p = strchr(p, '+');
+            p = (p != nullptr) ? p + 1 : nullptr;
+        }
+        if (p == nullptr) {
+            continue;
+        }
+        while (*p == ' ') {
+            p++;
+        }
+
+        size_t len = 0;
+
+        while (p[len] != '\0' && p[len] != ' ' && p[len] != '+') {
+            len++;
+        }
+        features |= FeatureByName(p, len);
+    }
+    return features;
+}
+
+size_t ImuReportScheduler::Plan(uint32_t features, uint32_t rateHz, Report* out)
+{
+    size_t n = 0;
+
+    mFeatures = features;
+    mRateHz = rateHz;
+    mStreams = 0;
+    mGridStarted = false;
+    mTick = 0;
+    memset(mHistory, 0, sizeof(mHistory));
+
+    // No grid (and a zero interval would turn the reports off); Push() ignores everything
+    if (rateHz == 0 || rateHz > 1000000U) {
+        return 0;
+    }
+
+    // Every grid tick must fall between two reports: report at least as fast as the grid
+    const uint32_t intervalUs = 1000000U / rateHz;
+
+    if (features & cOrientation) {
+        out[n++] = {(features & Yaw) ? (sh2_SensorId_t)SH2_ROTATION_VECTOR
+                                     : (sh2_SensorId_t)SH2_GAME_ROTATION_VECTOR, intervalUs};
+        mStreams |= 1U << Orientation;
+    }
+    if (features & cAccel) {
+        out[n++] = {SH2_ACCELEROMETER, intervalUs};
+        mStreams |= 1U << Accel;
+    }
+    if (features & cGyro) {
+        out[n++] = {SH2_GYROSCOPE_CALIBRATED, intervalUs};
+        mStreams |= 1U << Gyro;
+    }
+    return n;
+}
+
+void ImuReportScheduler::Push(const sh2_SensorValue_t& value, Emit emit, void* user)
+{
+    Stream stream;
+    float v[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    switch (value.sensorId) {
+    case SH2_ROTATION_VECTOR:
+        stream = Orientation;
+        v[0] = value.un.rotationVector.i;
+        v[1] = value.un.rotationVector.j;
+        v[2] = value.un.rotationVector.k;
+        v[3] = value.un.rotationVector.real;
+        break;
+    case SH2_GAME_ROTATION_VECTOR:
+        stream = Orientation;
+        v[0] = value.un.gameRotationVector.i;
+        v[1] = value.un.gameRotationVector.j;
+        v[2] = value.un.gameRotationVector.k;
+        v[3] = value.un.gameRotationVector.real;
+        break;
+    case SH2_ACCELEROMETER:
+        stream = Accel;
+        v[0] = value.un.accelerometer.x;
+        v[1] = value.un.accelerometer.y;
+        v[2] = value.un.accelerometer.z;
+        break;
+    case SH2_GYROSCOPE_CALIBRATED:
+        stream = Gyro;
+        v[0] = value.un.gyroscope.x;
+        v[1] = value.un.gyroscope.y;
+        v[2] = value.un.gyroscope.z;
+        break;
+    default:
+        return;
+    }
+    if ((mStreams & (1U << stream)) == 0) {
+        return;
+    }
+
+    History& h = mHistory[stream];
+
+    if (h.count > 0 && value.timestamp <= h.t[h.count - 1]) {
+        return;     // duplicate or out of order
+    }
+    if (h.count == cDepth) {
+        memmove(&h.t[0], &h.t[1], (cDepth - 1) * sizeof(h.t[0]));
+        memmove(&h.v[0], &h.v[1], (cDepth - 1) * sizeof(h.v[0]));
+        h.count--;
+    }
+    h.t[h.count] = value.timestamp;
+    memcpy(h.v[h.count], v, sizeof(v));
+    h.count++;
+
+    // Ticks are emitted up to the oldest "newest report" across streams, so every one is
+    // bracketed everywhere; the grid starts once every stream has two reports
+    uint64_t horizon = UINT64_MAX;
+
+    for (uint8_t s = 0; s < StreamCount; ++s) {
+        if (mStreams & (1U << s)) {
+            const History& hs = mHistory[s];
+
+            if (hs.count < 2) {
+                return;
+            }
+            horizon = (hs.t[hs.count - 1] < horizon) ? hs.t[hs.count - 1] : horizon;
+        }
+    }
+    if (!mGridStarted) {
+        mT0 = 0;
+        for (uint8_t s = 0; s < StreamCount; ++s) {
+            if ((mStreams & (1U << s)) && mHistory[s].t[0] > mT0) {
+                mT0 = mHistory[s].t[0];
+            }
+        }
+        mTick = 0;
+        mGridStarted = true;
+    }
+
+    // t0 + k / rate from k itself, so rounding never accumulates into drift
+    for (uint64_t t = mT0 + (mTick * 1000000ULL) / mRateHz; t <= horizon;
+         t = mT0 + (mTick * 1000000ULL) / mRateHz) {
+        Sample sample;
+
+        if (Interpolate(t, sample)) {
+            emit(sample, user);
+        } else {
+            mSkippedTicks++;
+        }
+        mTick++;
+    }
+}
+
+bool ImuReportScheduler::Interpolate(uint64_t t, Sample& out) const
+{
+    memset(&out, 0, sizeof(out));
+    out.t_us = t;
+
+    for (uint8_t s = 0; s < StreamCount; ++s) {
+        if ((mStreams & (1U << s)) == 0) {
+            continue;
+        }
+
+        const History& h = mHistory[s];
+
+        if (t < h.t[0]) {
+            return false;   // already scrolled out: skip the tick rather than extrapolate
+        }
+
+        uint8_t i = 0;
+
+        while (i + 2 < h.count && t > h.t[i + 1]) {
+            i++;
+        }
+
+        const float a = (float)(t - h.t[i]) / (float)(h.t[i + 1] - h.t[i]);
+        const float* v0 = h.v[i];
+        const float* v1 = h.v[i + 1];
+
+        if (s == Orientation) {
+            // nlerp along the short arc
+            float dot = 0.0f;
+
+            for (int c = 0; c < 4; ++c) {
+                dot += v0[c] * v1[c];
+            }
+            const float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+            float norm = 0.0f;
+
+            for (int c = 0; c < 4; ++c) {
+                out.q[c] = (1.0f - a) * v0[c] + a * sign * v1[c];
+                norm += out.q[c] * out.q[c];
+            }
+            norm = (norm > 0.0f) ? 1.0f / sqrtf(norm) : 0.0f;
+            for (int c = 0; c < 4; ++c) {
+                out.q[c] *= norm;
+            }
+        } else {
+            float* dst = (s == Accel) ? out.acc : out.gyr;
+
+            for (int c = 0; c < 3; ++c) {
+                dst[c] = (1.0f - a) * v0[c] + a * v1[c];
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,123 @@
+#include <Drivers/QuaternionFrontEnd.hpp>
+#include <edge-impulse-sdk/dsp/config.hpp>
+#include <cmath>
+
+#if EIDSP_USE_CMSIS_DSP
+#include <edge-impulse-sdk/CMSIS/DSP/Include/dsp/quaternion_math_functions.h>
+#endif
+
+namespace {
+
+constexpr float cPi = 3.14159265358979f;
+constexpr float cHalfPi = 1.57079632679490f;
+
+// atan on [0, 1], Abramowitz & Stegun 4.4.49 (|error| <= 2e-8)
+inline float AtanUnit(float z)
+{
+    const float z2 = z * z;
+
+    return z * (0.9999993329f + z2 * (-0.3332985605f + z2 * (0.1994653599f + z2 * (-0.1390853351f +
+           z2 * (0.0964200441f + z2 * (-0.0559098861f + z2 * (0.0218612288f + z2 * -0.0040540580f)))))));
+}
+
+// Only selects, no library call, so a chunk loop over it vectorizes where the core can
+inline float Atan2(float y, float x)
+{
+    const float ax = fabsf(x);
+    const float ay = fabsf(y);
+    const float mx = (ax > ay) ? ax : ay;
+    const float mn = (ax > ay) ? ay : ax;
+    float r = AtanUnit((mx > 0.0f) ? mn / mx : 0.0f);
+
+    r = (ay > ax) ? cHalfPi - r : r;
+    r = (x < 0.0f) ? cPi - r : r;
+    return (y < 0.0f) ? -r : r;
+}
+
+/** Euler terms of one chunk: atan2(y, x) per angle */
+struct EulerTerms {
+    float rollY[QuaternionFrontEnd::cChunk], rollX[QuaternionFrontEnd::cChunk];
+    float pitchS[QuaternionFrontEnd::cChunk], pitchC[QuaternionFrontEnd::cChunk];
+    float yawY[QuaternionFrontEnd::cChunk], yawX[QuaternionFrontEnd::cChunk];
+};
+
+void Terms(const float* qi, const float* qj, const float* qk, const float* qr, size_t n, EulerTerms& t)
+{
+#if EIDSP_USE_CMSIS_DSP
+    // CMSIS order is (real, i, j, k), row major R00 R01 R02 R10 R11 R12 R20 R21 R22
+    float32_t q[QuaternionFrontEnd::cChunk * 4];
+    float32_t r[QuaternionFrontEnd::cChunk * 9];
+
+    for (size_t s = 0; s < n; ++s) {
+        q[4 * s + 0] = qr[s];
+        q[4 * s + 1] = qi[s];
+        q[4 * s + 2] = qj[s];
+        q[4 * s + 3] = qk[s];
+    }
+    arm_quaternion_normalize_f32(q, q, n);
+    arm_quaternion2rotation_f32(q, r, n);
+
+    for (size_t s = 0; s < n; ++s) {
+        const float32_t* m = &r[9 * s];
+
+        t.rollY[s] = m[7];
+        t.rollX[s] = m[8];
+        t.pitchS[s] = -m[6];
+        t.yawY[s] = m[3];
+        t.yawX[s] = m[0];
+    }
+#else
+    // Same matrix terms; the squared forms keep roll and yaw independent of |q|
+    for (size_t s = 0; s < n; ++s) {
+        const float i = qi[s], j = qj[s], k = qk[s], w = qr[s];
+        const float ii = i * i, jj = j * j, kk = k * k, ww = w * w;
+
+        t.rollY[s] = 2.0f * (w * i + j * k);
+        t.rollX[s] = ww - ii - jj + kk;
+        t.pitchS[s] = 2.0f * (w * j - k * i) / (ww + ii + jj + kk);
+        t.yawY[s] = 2.0f * (w * k + i * j);
+        t.yawX[s] = ww + ii - jj - kk;
+    }
+#endif
+    // asin(s) as atan2(s, sqrt(1 - s^2)), clamped like BNO085::getPitch()
+    for (size_t s = 0; s < n; ++s) {
+        const float sp = fmaxf(-1.0f, fminf(1.0f, t.pitchS[s]));
+
+        t.pitchS[s] = sp;
+        t.pitchC[s] = sqrtf(1.0f - sp * sp);
+    }
+}
+
+} // namespace
+
+void QuaternionFrontEnd::Convert(const float* qi, const float* qj, const float* qk, const float* qr,
+                                 size_t count, float* out) const
+{
+    EulerTerms t;
+    float columns[AxisCount][cChunk];
+
+    for (size_t base = 0; base < count; base += cChunk) {
+        const size_t n = (count - base < cChunk) ? count - base : cChunk;
+
+        Terms(&qi[base], &qj[base], &qk[base], &qr[base], n, t);
+
+        for (size_t s = 0; s < n; ++s) {
+            columns[Roll][s] = Atan2(t.rollY[s], t.rollX[s]);
+            columns[Pitch][s] = Atan2(t.pitchS[s], t.pitchC[s]);
+            columns[Yaw][s] = Atan2(t.yawY[s], t.yawX[s]);
+            columns[QX][s] = qi[base + s];
+            columns[QY][s] = qj[base + s];
+            columns[QZ][s] = qk[base + s];
+            columns[QW][s] = qr[base + s];
+        }
+
+        // Interleave the selected axes, frame by frame
+        float* f = &out[base * mAxesCount];
+
+        for (size_t s = 0; s < n; ++s) {
+            for (size_t a = 0; a < mAxesCount; ++a) {
+                *f++ = (mAxes[a] < AxisCount) ? columns[mAxes[a]][s] : 0.0f;
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * Live IMU and classifier plots on the chosen display, with lvgl_timeseries_widget:
+ *   top:    the first three impulse axes (roll, pitch, yaw in degrees) from Service::Acquisition
+ *   bottom: each label's score in percent from inference_chan
+ * Both feeds only bump a min/max bucket in the producer's context; the LVGL thread below draws.
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+
+#if defined(CONFIG_LVGL) && DT_HAS_CHOSEN(zephyr_display)
+
+#include <Drivers/lvgl_timeseries_widget.h>
+#include <Services/Acquisition.hpp>
+#include <Services/Inference.hpp>
+
+#include <zephyr/drivers/display.h>
+#include <zephyr/zbus/zbus.h>
+
+#define LOG_LEVEL 3
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(SensorDisplay);
+
+namespace {
+	constexpr size_t cFrameFloats = EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+	constexpr size_t cImuChannels = MIN(cFrameFloats, (size_t)3);
+	constexpr size_t cScoreChannels = MIN(EImpulse::cLabelCount, (size_t)TS_WIDGET_MAX_CHANNELS);
+	constexpr float cDegrees = 57.29578f;	/* front end angles are radians */
+
+	/* 153 Hz over 128 columns of 5 samples: ~4 s across */
+	const struct ts_widget_cfg imuCfg = {
+		.width = 128, .height = 40, .columns = 128, .samples_per_col = 5,
+		.y_min = -180, .y_max = 180, .autoscale = false, .refresh_ms = 100,
+	};
+	/* one window per column */
+	const struct ts_widget_cfg scoreCfg = {
+		.width = 128, .height = 24, .columns = 64, .samples_per_col = 1,
+		.y_min = 0, .y_max = 100, .autoscale = false, .refresh_ms = 500,
+	};
+	const lv_palette_t palette[] = {LV_PALETTE_RED, LV_PALETTE_GREEN, LV_PALETTE_BLUE, LV_PALETTE_AMBER};
+
+	struct ts_widget imu;
+	struct ts_widget scores;
+
+	/* Service::Acquisition's producer thread */
+	void OnFrames(const float* frames, size_t count)
+	{
+		for (size_t f = 0; f < count; f++) {
+			for (size_t ax = 0; ax < cImuChannels; ax++) {
+				ts_widget_add_sample(&imu, ax, (int32_t)(frames[f * cFrameFloats + ax] * cDegrees));
+			}
+		}
+	}
+
+	/* Service::Inference's thread, from zbus_chan_pub() */
+	void OnInference(const struct zbus_channel *chan)
+	{
+		const struct inference_msg *msg = static_cast<const struct inference_msg *>(zbus_chan_const_msg(chan));
+
+		if (msg->error != 0) {
+			return;
+		}
+		for (size_t ix = 0; ix < cScoreChannels; ix++) {
+			ts_widget_add_sample(&scores, ix, (int32_t)(msg->scores[ix] * 100.0f));
+		}
+	}
+}
+
+ZBUS_LISTENER_DEFINE(sensor_display_lis, OnInference);
+ZBUS_CHAN_ADD_OBS(inference_chan, sensor_display_lis, 3);
+
+static void sensor_display_task(void *, void *, void *)
+{
+	const struct device *display = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+
+	if (!device_is_ready(display)) {
+		LOG_ERR("%s: display not ready", __func__);
+		return;
+	}
+
+	lv_obj_t *scr = lv_scr_act();
+
+	ts_widget_init(&imu, scr, &imuCfg);
+	for (size_t ax = 0; ax < cImuChannels; ax++) {
+		ts_widget_add_channel(&imu, lv_palette_main(palette[ax]));
+	}
+	ts_widget_init(&scores, scr, &scoreCfg);
+	lv_obj_align(scores.chart, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+	for (size_t ix = 0; ix < cScoreChannels; ix++) {
+		ts_widget_add_channel(&scores, lv_palette_main(palette[ix]));
+	}
+
+	Service::Acquisition::Tap(OnFrames);
+	display_blanking_off(display);
+
+	while (true) {
+		/* ms until the next LVGL timer */
+		k_msleep(MIN(lv_timer_handler(), 100U));
+	}
+}
+
+/* Lowest application priority: drawing never delays the pipeline */
+K_THREAD_DEFINE(sensor_display_task_id, 4096, sensor_display_task, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
+#endif /* CONFIG_LVGL && DT_HAS_CHOSEN(zephyr_display) */
@@ -0,0 +1,127 @@
+#include <Drivers/ShtpAsync.hpp>
+#include <errno.h>
+#include <cstring>
+
+// One wrapped hal at a time: the HAL trampolines get the sh2_Hal_t, not the wrapper
+static ShtpAsyncHal* sAsyncHal = nullptr;
+
+int ShtpAsyncReader::Read(uint8_t *buffer, size_t capacity, DoneCallback done, void *user)
+{
+    if (capacity < cHeaderLen) {
+        return -EINVAL;
+    }
+    mBuffer = buffer;
+    mCapacity = capacity;
+    mDone = done;
+    mUser = user;
+    return mBus.readAsync(mAddress, mHeader, cHeaderLen, OnHeader, this);
+}
+
+void ShtpAsyncReader::OnHeader(int result, void *self)
+{
+    ShtpAsyncReader *r = static_cast<ShtpAsyncReader *>(self);
+
+    if (result != 0) {
+        r->mDone(result, r->mUser);
+        return;
+    }
+
+    // Length is LE16 with the continuation bit on top; 0 means nothing pending
+    r->mLength = (size_t)((r->mHeader[0] | (r->mHeader[1] << 8)) & 0x7FFF);
+    if (r->mLength == 0) {
+        r->mDone(0, r->mUser);
+        return;
+    }
+    r->mLength = MIN(r->mLength, r->mCapacity);
+
+    int rc = r->mBus.readAsync(r->mAddress, r->mBuffer, r->mLength, OnCargo, self);
+
+    if (rc != 0) {
+        r->mDone(rc, r->mUser);
+    }
+}
+
+void ShtpAsyncReader::OnCargo(int result, void *self)
+{
+    ShtpAsyncReader *r = static_cast<ShtpAsyncReader *>(self);
+
+    r->mDone(result == 0 ? (int)r->mLength : result, r->mUser);
+}
+
+void ShtpAsyncHal::Wrap(sh2_Hal_t &hal, ReadyCallback ready)
+{
+    mInner = hal;
+    mHal = &hal;
+    mReady = ready;
+    sAsyncHal = this;
+    hal.read = Read;
+    hal.write = Write;
+}
+
+void ShtpAsyncHal::Kick()
+{
+    if (!atomic_cas(&mState, cIdle, cReading)) {
+        return;
+    }
+    mRxUs = mInner.getTimeUs(mHal);
+    if (mReader.Read(mRx, sizeof(mRx), OnRead, this) != 0) {
+        atomic_set(&mState, cIdle);
+    }
+}
+
+void ShtpAsyncHal::OnRead(int lenOrError, void *user)
+{
+    ShtpAsyncHal *a = static_cast<ShtpAsyncHal *>(user);
+
+    // Nothing pending (0) or a bus error: back to idle, the next Kick() retries
+    if (lenOrError <= 0) {
+        atomic_set(&a->mState, cIdle);
+        return;
+    }
+    a->mRxLength = lenOrError;
+    atomic_set(&a->mState, cFull);
+    if (a->mReady != nullptr) {
+        a->mReady();
+    }
+}
+
+int ShtpAsyncHal::Read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    ARG_UNUSED(self);
+    ShtpAsyncHal *a = sAsyncHal;
+
+    if (atomic_get(&a->mState) != cFull) {
+        a->Kick();
+        return 0;
+    }
+
+    const int length = ((unsigned)a->mRxLength <= len) ? a->mRxLength : 0;
+
+    memcpy(pBuffer, a->mRx, length);
+    *t_us = a->mRxUs;
+    atomic_set(&a->mState, cIdle);
+    return length;
+}
+
+int ShtpAsyncHal::Write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len)
+{
+    ARG_UNUSED(self);
+    ShtpAsyncHal *a = sAsyncHal;
+
+    if (len > sizeof(a->mTx) || !atomic_cas(&a->mWriting, 0, 1)) {
+        return 0;
+    }
+    memcpy(a->mTx, pBuffer, len);
+    if (a->mBus.writeAsync(a->mAddress, a->mTx, len, OnWrite, a) != 0) {
+        atomic_clear(&a->mWriting);
+        return 0;
+    }
+    return (int)len;
+}
+
+void ShtpAsyncHal::OnWrite(int result, void *user)
+{
+    ARG_UNUSED(result);
+
+    atomic_clear(&static_cast<ShtpAsyncHal *>(user)->mWriting);
+}
@@ -0,0 +1,158 @@
+#include <Drivers/ShtpCapture.hpp>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <cstring>
+
+// One recorded hal at a time: the trampolines get the wrapped sh2_Hal_t, not the recorder
+static ShtpRecorder* sRecorder = nullptr;
+
+void ShtpRecorder::Wrap(sh2_Hal_t &hal)
+{
+    const uint8_t header[cShtpCaptureFileHeader] = {'S', 'H', 'T', 'P', cShtpCaptureVersion, 0, 0, 0};
+
+    mInner = hal;
+    sRecorder = this;
+    hal.read = Read;
+    hal.write = Write;
+    mSink(header, sizeof(header), mUser);
+}
+
+void ShtpRecorder::Emit(uint32_t t_us, const uint8_t *data, unsigned len, uint16_t direction)
+{
+    uint8_t record[cShtpCaptureRecordHeader + SH2_HAL_MAX_TRANSFER_IN];
+
+    len = MIN(len, (unsigned)SH2_HAL_MAX_TRANSFER_IN);
+    sys_put_le32(t_us, &record[0]);
+    sys_put_le16((uint16_t)len | direction, &record[4]);
+    memcpy(&record[cShtpCaptureRecordHeader], data, len);
+    mSink(record, cShtpCaptureRecordHeader + len, mUser);
+    mRecords++;
+}
+
+int ShtpRecorder::Read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    ShtpRecorder *r = sRecorder;
+    const int got = r->mInner.read(self, pBuffer, len, t_us);
+
+    if (got > 0) {
+        r->Emit(*t_us, pBuffer, (unsigned)got, 0);
+    }
+    return got;
+}
+
+int ShtpRecorder::Write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len)
+{
+    ShtpRecorder *r = sRecorder;
+    const int sent = r->mInner.write(self, pBuffer, len);
+
+    if (sent > 0) {
+        r->Emit(r->mInner.getTimeUs(self), pBuffer, (unsigned)sent, cShtpCaptureOut);
+    }
+    return sent;
+}
+
+ShtpReplay::ShtpReplay(const uint8_t *capture, size_t len, Pace pace)
+    : mCapture(capture), mLength(len), mPace(pace)
+{
+    mHal.open = Open;
+    mHal.close = Close;
+    mHal.read = Read;
+    mHal.write = Write;
+    mHal.getTimeUs = GetTimeUs;
+
+    mValid = len >= cShtpCaptureFileHeader && memcmp(capture, "SHTP", 4) == 0 &&
+             capture[4] == cShtpCaptureVersion;
+    mOffset = mValid ? cShtpCaptureFileHeader : len;
+}
+
+uint32_t ShtpReplay::Now() const
+{
+    if (mPace == Pace::AsFastAsPossible) {
+        return mVirtualUs;
+    }
+    // Recorded time base, advanced by the kernel clock since Open()
+    return mFirstUs + (k_cyc_to_us_floor32(k_cycle_get_32()) - mStartUs);
+}
+
+// Skips host-to-hub records; true if mOffset is at a complete inbound record
+bool ShtpReplay::NextInbound()
+{
+    while (mOffset + cShtpCaptureRecordHeader <= mLength) {
+        const uint16_t word = sys_get_le16(&mCapture[mOffset + 4]);
+        const size_t len = word & ~cShtpCaptureOut;
+
+        if (mOffset + cShtpCaptureRecordHeader + len > mLength) {
+            break;      // truncated tail
+        }
+        if ((word & cShtpCaptureOut) == 0) {
+            return true;
+        }
+        mOffset += cShtpCaptureRecordHeader + len;
+    }
+    mOffset = mLength;
+    return false;
+}
+
+int ShtpReplay::Open(sh2_Hal_t *self)
+{
+    ShtpReplay *r = reinterpret_cast<ShtpReplay *>(self);
+
+    if (!r->mValid) {
+        return -1;
+    }
+    r->mOffset = cShtpCaptureFileHeader;
+    r->mTransfers = 0;
+    r->mFirstUs = r->NextInbound() ? sys_get_le32(&r->mCapture[r->mOffset]) : 0;
+    r->mVirtualUs = r->mFirstUs;
+    r->mStartUs = k_cyc_to_us_floor32(k_cycle_get_32());
+    return 0;
+}
+
+void ShtpReplay::Close(sh2_Hal_t *self)
+{
+    ShtpReplay *r = reinterpret_cast<ShtpReplay *>(self);
+
+    r->mOffset = r->mLength;
+}
+
+int ShtpReplay::Read(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    ShtpReplay *r = reinterpret_cast<ShtpReplay *>(self);
+
+    if (!r->NextInbound()) {
+        // Keep sh2 timeouts expiring once the capture is exhausted
+        r->mVirtualUs += 1000;
+        return 0;
+    }
+
+    const uint8_t *record = &r->mCapture[r->mOffset];
+    const uint32_t at = sys_get_le32(&record[0]);
+    const unsigned length = sys_get_le16(&record[4]) & ~cShtpCaptureOut;
+
+    if (r->mPace == Pace::RealTime && (int32_t)(r->Now() - at) < 0) {
+        return 0;       // not due yet
+    }
+    if (length > len) {
+        r->mOffset += cShtpCaptureRecordHeader + length;
+        return 0;
+    }
+    memcpy(pBuffer, &record[cShtpCaptureRecordHeader], length);
+    *t_us = at;
+    r->mVirtualUs = at;
+    r->mOffset += cShtpCaptureRecordHeader + length;
+    r->mTransfers++;
+    return (int)length;
+}
+
+int ShtpReplay::Write(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len)
+{
+    ARG_UNUSED(self);
+    ARG_UNUSED(pBuffer);
+
+    return (int)len;
+}
+
+uint32_t ShtpReplay::GetTimeUs(sh2_Hal_t *self)
+{
+    return reinterpret_cast<ShtpReplay *>(self)->Now();
+}
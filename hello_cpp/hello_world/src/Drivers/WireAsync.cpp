@@ -0,0 +1,135 @@
+// Async, zero-copy transactions for arduino::ZephyrI2C (see Wire.h)
+
+#include <Drivers/Wire.h>
+#include <errno.h>
+
+int arduino::ZephyrI2C::transferAsync(uint8_t address, struct i2c_msg *msgs, uint8_t num,
+                                      TransferCallback cb, void *user)
+{
+  if (num == 0 || num > cMaxMsgs) {
+    return -EINVAL;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&asyncLock);
+
+  if (!asyncInit) {
+    k_work_init(&asyncWork.work, onWork);
+    asyncWork.owner = this;
+    asyncInit = true;
+  }
+  if (asyncCount == cQueueDepth) {
+    k_spin_unlock(&asyncLock, key);
+    return -ENOBUFS;
+  }
+
+  Transaction &t = asyncQueue[(asyncHead + asyncCount) % cQueueDepth];
+
+  for (uint8_t i = 0; i < num; ++i) {
+    t.msgs[i] = msgs[i];
+  }
+  t.num = num;
+  t.address = address;
+  t.cb = cb;
+  t.user = user;
+  asyncCount++;
+
+  const bool idle = !asyncBusy;
+
+  asyncBusy = true;
+  k_spin_unlock(&asyncLock, key);
+
+  if (idle) {
+    startNext();
+  }
+  return 0;
+}
+
+int arduino::ZephyrI2C::readAsync(uint8_t address, uint8_t *rx, size_t len, TransferCallback cb,
+                                  void *user)
+{
+  struct i2c_msg msg = {.buf = rx, .len = (uint32_t)len, .flags = I2C_MSG_READ | I2C_MSG_STOP};
+
+  return transferAsync(address, &msg, 1, cb, user);
+}
+
+int arduino::ZephyrI2C::writeAsync(uint8_t address, const uint8_t *tx, size_t len,
+                                   TransferCallback cb, void *user)
+{
+  struct i2c_msg msg = {
+    .buf = const_cast<uint8_t *>(tx), .len = (uint32_t)len, .flags = I2C_MSG_WRITE | I2C_MSG_STOP};
+
+  return transferAsync(address, &msg, 1, cb, user);
+}
+
+int arduino::ZephyrI2C::writeReadAsync(uint8_t address, const uint8_t *tx, size_t txLen,
+                                       uint8_t *rx, size_t rxLen, TransferCallback cb, void *user)
+{
+  struct i2c_msg msgs[2] = {
+    {.buf = const_cast<uint8_t *>(tx), .len = (uint32_t)txLen, .flags = I2C_MSG_WRITE},
+    {.buf = rx, .len = (uint32_t)rxLen, .flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP},
+  };
+
+  return transferAsync(address, msgs, 2, cb, user);
+}
+
+// Runs the head of the queue; only one transaction is ever in flight
+void arduino::ZephyrI2C::startNext()
+{
+  Transaction &t = asyncQueue[asyncHead];
+
+#if defined(CONFIG_I2C_CALLBACK)
+  int rc = i2c_transfer_cb(i2c_dev, t.msgs, t.num, t.address, onTransferDone, this);
+
+  if (rc != -ENOSYS) {
+    if (rc != 0) {
+      complete(rc);
+    }
+    return;
+  }
+#else
+  ARG_UNUSED(t);
+#endif
+  // Driver without a callback API: keep the caller non-blocking, block the work queue instead
+  k_work_submit(&asyncWork.work);
+}
+
+void arduino::ZephyrI2C::complete(int result)
+{
+  const Transaction &t = asyncQueue[asyncHead];
+  const TransferCallback cb = t.cb;
+  void *user = t.user;
+
+  k_spinlock_key_t key = k_spin_lock(&asyncLock);
+
+  asyncHead = (asyncHead + 1) % cQueueDepth;
+  asyncCount--;
+
+  const bool more = asyncCount > 0;
+
+  asyncBusy = more;
+  k_spin_unlock(&asyncLock, key);
+
+  // Start the next transfer before the callback so the bus does not idle while it runs
+  if (more) {
+    startNext();
+  }
+  if (cb != nullptr) {
+    cb(result, user);
+  }
+}
+
+void arduino::ZephyrI2C::onTransferDone(const struct device *dev, int result, void *data)
+{
+  ARG_UNUSED(dev);
+
+  static_cast<ZephyrI2C *>(data)->complete(result);
+}
+
+void arduino::ZephyrI2C::onWork(struct k_work *work)
+{
+  AsyncWork *w = CONTAINER_OF(work, AsyncWork, work);
+  ZephyrI2C *self = w->owner;
+  Transaction &t = self->asyncQueue[self->asyncHead];
+
+  self->complete(i2c_transfer(self->i2c_dev, t.msgs, t.num, t.address));
+}
@@ -0,0 +1,172 @@
+/*
+ * lvgl_timeseries_widget.h/.c
+ * Compact, KISS C module for Zephyr + LVGL (v8 API), same layout as lora/receive's lvgl_statistics_widget.c
+ * - Plots high-rate samples (IMU at 153 Hz, BME688, classifier confidence) on a small chart.
+ * - Decimation: every chart column is one min/max bucket of samples_per_col samples. A sample only
+ *   updates the running min/max of the open bucket, O(1), and no raw history is kept anywhere.
+ * - Rendering: each column is two chart points (min then max), drawn as a vertical stroke, so peaks
+ *   between pixels stay visible instead of aliasing away.
+ * - Producers may run in any thread or ISR (spinlock around the bucket); finished columns wait in a
+ *   short per-channel ring until the LVGL timer writes them. The chart is circular and a column goes
+ *   in as two lv_chart_set_next_value() calls, which invalidate only the points around it
+ *   (lv_chart_set_value_by_id() would refresh the whole chart).
+ */
+
+/* ===================== lvgl_timeseries_widget.c ===================== */
+
+#include <zephyr/kernel.h>
+
+/* Only with a display: west build -- -DEXTRA_CONF_FILE=overlay-display.conf */
+#if defined(CONFIG_LVGL)
+
+#include "lvgl_timeseries_widget.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(ts_widget, LOG_LEVEL_INF);
+
+/* forward */
+static void lv_tick_cb(lv_timer_t *t);
+
+int ts_widget_init(struct ts_widget *w, lv_obj_t *parent, const struct ts_widget_cfg *cfg)
+{
+    if (cfg->columns == 0 || cfg->columns > TS_WIDGET_MAX_COLUMNS || cfg->samples_per_col == 0) {
+        return -EINVAL;
+    }
+
+    memset(w, 0, sizeof(*w));
+    w->cfg = *cfg;
+
+    /* create chart: two points per column, min and max */
+    w->chart = lv_chart_create(parent);
+    lv_obj_set_size(w->chart, cfg->width, cfg->height);
+    lv_chart_set_type(w->chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_point_count(w->chart, 2 * cfg->columns);
+    lv_obj_align(w->chart, LV_ALIGN_TOP_LEFT, 0, 0);
+    lv_chart_set_div_line_count(w->chart, 0, 0);
+    lv_chart_set_range(w->chart, LV_CHART_AXIS_PRIMARY_Y, cfg->y_min, cfg->y_max);
+    lv_obj_set_style_bg_opa(w->chart, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_width(w->chart, 0, LV_PART_INDICATOR); /* no point markers */
+    lv_obj_set_style_height(w->chart, 0, LV_PART_INDICATOR);
+    lv_chart_set_update_mode(w->chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+
+    /* start lv_timer that moves finished columns into the chart */
+    w->timer = lv_timer_create(lv_tick_cb, cfg->refresh_ms ? cfg->refresh_ms : 100, w);
+
+    return 0;
+}
+
+int ts_widget_add_channel(struct ts_widget *w, lv_color_t color)
+{
+    struct ts_channel *c;
+
+    if (w->channel_count >= TS_WIDGET_MAX_CHANNELS) {
+        return -ENOMEM;
+    }
+
+    c = &w->ch[w->channel_count];
+    c->series = lv_chart_add_series(w->chart, color, LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_all_value(w->chart, c->series, LV_CHART_POINT_NONE);
+    c->acc_count = 0;
+
+    return w->channel_count++;
+}
+
+/* Close the open bucket into the pending ring (lock held) */
+static void commit_bucket(struct ts_channel *c)
+{
+    uint8_t slot;
+
+    if (c->pending_count == TS_WIDGET_PENDING) {
+        /* GUI is behind: drop the oldest finished column */
+        c->pending_head = (c->pending_head + 1) % TS_WIDGET_PENDING;
+        c->pending_count--;
+        c->overruns++;
+    }
+    slot = (c->pending_head + c->pending_count) % TS_WIDGET_PENDING;
+    c->pending[slot] = c->acc;
+    c->pending_count++;
+    c->acc_count = 0;
+}
+
+void ts_widget_add_sample(struct ts_widget *w, uint8_t channel, int32_t value)
+{
+    struct ts_channel *c;
+    k_spinlock_key_t key;
+
+    if (channel >= w->channel_count) {
+        return;
+    }
+    c = &w->ch[channel];
+
+    key = k_spin_lock(&w->lock);
+    if (c->acc_count == 0) {
+        c->acc.min = value;
+        c->acc.max = value;
+    } else {
+        c->acc.min = MIN(c->acc.min, value);
+        c->acc.max = MAX(c->acc.max, value);
+    }
+    if (++c->acc_count >= w->cfg.samples_per_col) {
+        commit_bucket(c);
+    }
+    k_spin_unlock(&w->lock, key);
+}
+
+void ts_widget_add_samples(struct ts_widget *w, uint8_t channel, const int32_t *values, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        ts_widget_add_sample(w, channel, values[i]);
+    }
+}
+
+/* Widen the y range when a column does not fit (autoscale only grows) */
+static void fit_range(struct ts_widget *w, const struct ts_bucket *b)
+{
+    bool changed = false;
+
+    if (b->min < w->cfg.y_min) {
+        w->cfg.y_min = b->min;
+        changed = true;
+    }
+    if (b->max > w->cfg.y_max) {
+        w->cfg.y_max = b->max;
+        changed = true;
+    }
+    if (changed) {
+        lv_chart_set_range(w->chart, LV_CHART_AXIS_PRIMARY_Y, w->cfg.y_min, w->cfg.y_max);
+    }
+}
+
+/* LVGL timer: drain finished columns; each is appended at the series' start point, min then max */
+static void lv_tick_cb(lv_timer_t *t)
+{
+    struct ts_widget *w = t->user_data;
+
+    for (uint8_t i = 0; i < w->channel_count; ++i) {
+        struct ts_channel *c = &w->ch[i];
+
+        while (1) {
+            struct ts_bucket b;
+            k_spinlock_key_t key = k_spin_lock(&w->lock);
+
+            if (c->pending_count == 0) {
+                k_spin_unlock(&w->lock, key);
+                break;
+            }
+            b = c->pending[c->pending_head];
+            c->pending_head = (c->pending_head + 1) % TS_WIDGET_PENDING;
+            c->pending_count--;
+            k_spin_unlock(&w->lock, key);
+
+            if (w->cfg.autoscale) {
+                fit_range(w, &b);
+            }
+
+            lv_chart_set_next_value(w->chart, c->series, b.min);
+            lv_chart_set_next_value(w->chart, c->series, b.max);
+        }
+    }
+}
+
+#endif /* CONFIG_LVGL */
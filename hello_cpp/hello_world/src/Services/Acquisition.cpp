@@ -0,0 +1,183 @@
+#include <Services/Acquisition.hpp>
+
+#include <System.hpp>
+#include <Drivers/BNO085Stream.hpp>
+
+#define LOG_LEVEL 3
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(Acquisition);
+
+namespace {
+	#define CMD_ACQUISITION_DRAIN 0x31
+	#define DRAIN_PERIOD_MS 100	/* only covers a missed H_INTN edge */
+	constexpr size_t cFrameFloats = EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+	constexpr size_t cWindowFrames = EImpulse::cWindowFloats / cFrameFloats;
+
+	static Pipeline::StageStats stats;
+	static Pipeline::Window* window = nullptr;	/* slot being filled, owned by this stage */
+	static size_t filled = 0;					/* frames already in it */
+	static uint32_t firstAt = 0;				/* cycle count of its first frame */
+	static uint32_t windows = 0;
+	static void (*volatile tap)(const float* frames, size_t count) = nullptr;
+
+#if BNO085_HAS_INT
+	static BNO085Stream stream;
+	static struct k_timer timer;
+	static volatile uint32_t notifiedAt = 0;
+	static const uint8_t msgDrain[] = {CMD_ACQUISITION_DRAIN, 0x0};
+
+	// I2C completion of a transfer and timer expiry: the drain runs on the service's thread
+	void Notify() {
+		notifiedAt = k_cycle_get_32();
+		Service::Acquisition::Send(msgDrain);
+	}
+#endif /* BNO085_HAS_INT */
+}
+
+void Service::Acquisition::Initialize() {
+	// Above every other service: sampling never waits for the DSP or the NN
+	zpp::this_thread::set_priority(zpp::thread_prio::preempt(1));
+
+#if BNO085_HAS_INT
+	stream.Notify(Notify);
+	if (!stream.Start(EImpulse::Axes(), EImpulse::AxesCount(), EI_CLASSIFIER_FREQUENCY)) {
+		LOG_ERR("%s: no IMU, nothing to acquire", __FUNCTION__);
+		return;
+	}
+	k_timer_init(&timer, [](struct k_timer *timer_id) { Notify(); }, NULL);
+	k_timer_start(&timer, K_MSEC(DRAIN_PERIOD_MS), K_MSEC(DRAIN_PERIOD_MS));
+#endif /* BNO085_HAS_INT */
+
+    LOG_INF("%s: Acquisition Module Initialized correctly, windows of %u frames, %u slots.",
+			__FUNCTION__, (unsigned int)cWindowFrames, (unsigned int)Pipeline::Windows::Capacity());
+}
+
+float* Service::Acquisition::Reserve(size_t& frames) {
+	if (window == nullptr) {
+		// First call; every slot is free until a window has been handed over
+		window = System::mWindows.Acquire();
+		filled = 0;
+		__ASSERT_NO_MSG(window != nullptr);
+	}
+	frames = cWindowFrames - filled;
+	return &window->data[filled * cFrameFloats];
+}
+
+void Service::Acquisition::Commit(size_t frames) {
+	const uint32_t now = k_cycle_get_32();
+
+	if (filled == 0) {
+		firstAt = now;
+	}
+	void (*const onFrames)(const float*, size_t) = tap;
+	if (onFrames != nullptr) {
+		onFrames(&window->data[filled * cFrameFloats], frames);
+	}
+	filled += frames;
+	if (filled < cWindowFrames) {
+		return;
+	}
+
+	window->seq = windows++;
+	window->completedAt = now;
+	filled = 0;
+
+	Pipeline::Window* next = System::mWindows.Acquire();
+	if (next == nullptr) {
+		// The DSP still holds the other slot: lose this window and sample on into it. Wake it
+		// anyway, whatever it is waiting on it will find the queued window once it runs.
+		stats.dropped++;
+		Service::Dsp::Wake();
+		return;
+	}
+	stats.Record(k_cyc_to_us_floor32(now - firstAt));
+	System::mWindows.Submit(window);
+	window = next;
+	Service::Dsp::Wake();
+}
+
+void Service::Acquisition::Drain() {
+#if BNO085_HAS_INT
+	const uint32_t start = k_cycle_get_32();
+
+	stats.Waited(k_cyc_to_us_floor32(start - notifiedAt));
+	stream.Drain();
+	stats.Busy(k_cyc_to_us_floor32(k_cycle_get_32() - start));
+#endif /* BNO085_HAS_INT */
+}
+
+void Service::Acquisition::Tap(void (*onFrames)(const float* frames, size_t count)) {
+	tap = onFrames;
+}
+
+const Pipeline::StageStats& Service::Acquisition::Stats() {
+	return stats;
+}
+
+void Service::Acquisition::Handle(const uint8_t arg[]) {
+    /**
+     * Handle arg packet.
+     */
+    switch(arg[0])
+    {
+		case CMD_ACQUISITION_DRAIN:
+		{
+			Drain();
+		}; break;
+        default:
+        {
+            LOG_WRN("[Service::%s]::%s():\t%x.\tIgnored.", mName, __func__, arg[0]);
+            break;
+        }
+    };
+}
+
+/**
+ * Build the static members on the RTOS::ActiveObject
+ */
+namespace Service
+{
+    using                       _Acquisition = RTOS::ActiveObject<Service::Acquisition>;
+
+    template <>
+    const char               	_Acquisition::mName[] =  "Acquisition";
+    template <>
+    uint8_t                     _Acquisition::mCountLoops = 0;
+    template <>
+    const uint8_t               _Acquisition::mInputQueueItemLength = 16;
+    template <>
+    const uint8_t               _Acquisition::mInputQueueItemSize = sizeof(uint16_t);
+    template <>
+    const size_t                _Acquisition::mInputQueueSizeBytes =
+                                        RTOS::ActiveObject<Service::Acquisition>::mInputQueueItemLength
+                                        * RTOS::ActiveObject<Service::Acquisition>::mInputQueueItemSize;
+    template <>
+    char                        _Acquisition::mInputQueueAllocation[
+                                        RTOS::ActiveObject<Service::Acquisition>::mInputQueueSizeBytes
+                                    ] = { 0 };
+    template <>
+    RTOS::QueueHandle_t         _Acquisition::mInputQueue = RTOS::Hal::QueueCreate(
+                                        RTOS::ActiveObject<Service::Acquisition>::mInputQueueItemLength,
+                                        RTOS::ActiveObject<Service::Acquisition>::mInputQueueItemSize,
+                                        RTOS::ActiveObject<Service::Acquisition>::mInputQueueAllocation
+                                    );
+    template <>
+    uint8_t                     _Acquisition::mReceivedMsg[
+                                        RTOS::ActiveObject<Service::Acquisition>::mInputQueueItemLength
+                                    ] = { 0 };
+
+
+    namespace {
+    // sh2_service() and the frame conversion, windows are static
+    ZPP_KERNEL_STACK_DEFINE(acquisitionstack, 2048);
+    template <>
+    zpp::thread_data            _Acquisition::mTaskControlBlock = zpp::thread_data();
+    template <>
+    zpp::thread                 _Acquisition::mHandle = zpp::thread(
+                                        mTaskControlBlock,
+                                        Service::acquisitionstack(),
+                                        RTOS::cThreadAttributes,
+                                        Service::_Acquisition::Run
+                                    );
+    }
+}
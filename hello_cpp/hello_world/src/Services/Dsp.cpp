@@ -0,0 +1,135 @@
+#include <Services/Dsp.hpp>
+
+#include <System.hpp>
+
+#define LOG_LEVEL 3
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(Dsp);
+
+namespace {
+	#define CMD_DSP_WINDOW 0x41
+
+	static Pipeline::StageStats stats;
+}
+
+void Service::Dsp::Initialize() {
+    LOG_INF("%s: Dsp Module Initialized correctly, %u features per window.", __FUNCTION__,
+			(unsigned int)EImpulse::cFeatureCount);
+	// Below Acquisition, above the NN: the next window's features preempt the classifier
+	zpp::this_thread::set_priority(zpp::thread_prio::preempt(5));
+}
+
+void Service::Dsp::Wake() {
+	static const uint8_t msg[] = {CMD_DSP_WINDOW, 0x0};
+
+	Send(msg);
+}
+
+const Pipeline::StageStats& Service::Dsp::Stats() {
+	return stats;
+}
+
+void Service::Dsp::Extract() {
+	// Drain every queued window, wake-ups may have been purged meanwhile
+	while (true) {
+		// Output slot first: with none free the window waits in its queue, not here, and the NN
+		// is nudged in case its own wake-up was lost
+		Pipeline::Features* features = System::mFeatures.Acquire();
+		if (features == nullptr) {
+			Service::Inference::Wake();
+			break;
+		}
+		uint32_t waitUs = 0;
+		Pipeline::Window* window = System::mWindows.Take(&waitUs);
+		if (window == nullptr) {
+			System::mFeatures.Release(features);
+			break;
+		}
+
+		const uint32_t start = k_cycle_get_32();
+		features->error = EImpulse::Extract(window->data, features->data);
+		features->seq = window->seq;
+		features->completedAt = window->completedAt;
+		System::mWindows.Release(window);
+
+		const uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+		features->dspUs = us;
+		stats.Waited(waitUs);
+		stats.Busy(us);
+		stats.Record(us);
+		if (features->error != 0) {
+			LOG_ERR("window %u: DSP failed (%d)", features->seq, features->error);
+		}
+
+		System::mFeatures.Submit(features);
+		Service::Inference::Wake();
+	}
+}
+
+void Service::Dsp::Handle(const uint8_t arg[]) {
+    /**
+     * Handle arg packet.
+     */
+    switch(arg[0])
+    {
+		case CMD_DSP_WINDOW:
+		{
+			Extract();
+		}; break;
+        default:
+        {
+            LOG_WRN("[Service::%s]::%s():\t%x.\tIgnored.", mName, __func__, arg[0]);
+            break;
+        }
+    };
+}
+
+/**
+ * Build the static members on the RTOS::ActiveObject
+ */
+namespace Service
+{
+    using                       _Dsp = RTOS::ActiveObject<Service::Dsp>;
+
+    template <>
+    const char               	_Dsp::mName[] =  "Dsp";
+    template <>
+    uint8_t                     _Dsp::mCountLoops = 0;
+    template <>
+    const uint8_t               _Dsp::mInputQueueItemLength = 16;
+    template <>
+    const uint8_t               _Dsp::mInputQueueItemSize = sizeof(uint16_t);
+    template <>
+    const size_t                _Dsp::mInputQueueSizeBytes =
+                                        RTOS::ActiveObject<Service::Dsp>::mInputQueueItemLength
+                                        * RTOS::ActiveObject<Service::Dsp>::mInputQueueItemSize;
+    template <>
+    char                        _Dsp::mInputQueueAllocation[
+                                        RTOS::ActiveObject<Service::Dsp>::mInputQueueSizeBytes
+                                    ] = { 0 };
+    template <>
+    RTOS::QueueHandle_t         _Dsp::mInputQueue = RTOS::Hal::QueueCreate(
+                                        RTOS::ActiveObject<Service::Dsp>::mInputQueueItemLength,
+                                        RTOS::ActiveObject<Service::Dsp>::mInputQueueItemSize,
+                                        RTOS::ActiveObject<Service::Dsp>::mInputQueueAllocation
+                                    );
+    template <>
+    uint8_t                     _Dsp::mReceivedMsg[
+                                        RTOS::ActiveObject<Service::Dsp>::mInputQueueItemLength
+                                    ] = { 0 };
+
+
+    namespace {
+    // DSP scratch is static, the stack holds the DSP block's locals
+    ZPP_KERNEL_STACK_DEFINE(dspstack, 4096);
+    template <>
+    zpp::thread_data            _Dsp::mTaskControlBlock = zpp::thread_data();
+    template <>
+    zpp::thread                 _Dsp::mHandle = zpp::thread(
+                                        mTaskControlBlock,
+                                        Service::dspstack(),
+                                        RTOS::cThreadAttributes,
+                                        Service::_Dsp::Run
+                                    );
+    }
+}
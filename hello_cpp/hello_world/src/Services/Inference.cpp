@@ -0,0 +1,195 @@
+#include <Services/Inference.hpp>
+
+#include <System.hpp>
+
+#define LOG_LEVEL 3
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(Inference);
+
+ZBUS_CHAN_DEFINE(inference_chan,  /* Name */
+	struct inference_msg, /* Message type */
+
+	NULL, /* Validator */
+	NULL, /* User data */
+	ZBUS_OBSERVERS_EMPTY, /* observers: runtime ones, zbus_chan_add_obs() */
+	ZBUS_MSG_INIT(.window = 0)  /* Initial value */
+);
+
+namespace {
+	#define CMD_INFERENCE_FEATURES 0x21
+	#define REPORT_EVERY 10	/* windows, ~10 s at one window per second */
+
+	static Pipeline::StageStats stats;
+	static ei_impulse_result_t result;
+	static uint32_t windows = 0;
+
+	/* over the last REPORT_EVERY windows */
+	static uint32_t reportedAt = 0;
+	static uint32_t busyAtReport[Pipeline::StageCount] = {};
+	static uint32_t latencyUsMax = 0;
+	static uint32_t errors = 0;
+}
+
+void Service::Inference::Initialize() {
+	EImpulse::Init();
+	reportedAt = k_cycle_get_32();
+    LOG_INF("%s: Inference Module Initialized correctly, %u frames of %u axes at %u Hz, %u labels.",
+			__FUNCTION__, EI_CLASSIFIER_RAW_SAMPLE_COUNT, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME,
+			EI_CLASSIFIER_FREQUENCY, (unsigned int)EImpulse::cLabelCount);
+	// Last stage, lowest priority: a late window only backs up the pipeline, never the sensor
+	zpp::this_thread::set_priority(zpp::thread_prio::preempt(6));
+}
+
+void Service::Inference::Wake() {
+	static const uint8_t msg[] = {CMD_INFERENCE_FEATURES, 0x0};
+
+	Send(msg);
+}
+
+const Pipeline::StageStats& Service::Inference::Stats() {
+	return stats;
+}
+
+void Service::Inference::Classify() {
+	Pipeline::Features* features;
+	uint32_t waitUs = 0;
+
+	// Drain every feature vector, Wake() messages may have been purged meanwhile
+	while ((features = System::mFeatures.Take(&waitUs)) != nullptr) {
+		struct inference_msg msg = {};
+		const uint32_t start = k_cycle_get_32();
+
+		msg.window = features->seq;
+		msg.dsp_us = features->dspUs;
+		msg.error = (features->error != 0) ? features->error : EImpulse::Classify(features->data, result);
+
+		const uint32_t now = k_cycle_get_32();
+		msg.classification_us = k_cyc_to_us_floor32(now - start);
+		msg.latency_us = k_cyc_to_us_floor32(now - features->completedAt);
+
+		// Hand the slot back before publishing, the DSP may be holding a window for it
+		System::mFeatures.Release(features);
+		if (System::mWindows.Ready() > 0) {
+			Service::Dsp::Wake();
+		}
+
+		stats.Waited(waitUs);
+		stats.Busy(msg.classification_us);
+		stats.Record(msg.classification_us);
+		latencyUsMax = MAX(latencyUsMax, msg.latency_us);
+		windows++;
+
+		if (msg.error == 0) {
+			msg.label = (uint8_t)EImpulse::Best(result);
+			for (size_t ix = 0; ix < EImpulse::cLabelCount; ix++) {
+				msg.scores[ix] = result.classification[ix].value;
+			}
+			LOG_DBG("window %u: %s (%u/1000), dsp %u us, nn %u us, latency %u us", msg.window,
+					EImpulse::Label(msg.label), (unsigned int)(msg.scores[msg.label] * 1000.0f),
+					msg.dsp_us, msg.classification_us, msg.latency_us);
+		} else {
+			errors++;
+			LOG_ERR("window %u: classification failed (%d)", msg.window, msg.error);
+		}
+
+		zbus_chan_pub(&inference_chan, &msg, K_MSEC(10));
+
+		if (windows % REPORT_EVERY == 0) {
+			Report();
+		}
+	}
+}
+
+void Service::Inference::Report() {
+	static const char* const names[Pipeline::StageCount] = {"acquisition", "dsp", "nn"};
+	const Pipeline::StageStats* stages[Pipeline::StageCount] = {
+		&Service::Acquisition::Stats(), &Service::Dsp::Stats(), &stats
+	};
+	const uint32_t now = k_cycle_get_32();
+	const uint32_t elapsedUs = MAX(k_cyc_to_us_floor32(now - reportedAt), 1U);
+
+	// Occupancy: share of the wall time the stage spent working since the last report
+	for (size_t ix = 0; ix < Pipeline::StageCount; ix++) {
+		const Pipeline::StageStats& s = *stages[ix];
+		const uint32_t permille = (uint32_t)((uint64_t)(s.busyUs - busyAtReport[ix]) * 1000U / elapsedUs);
+
+		LOG_INF("%s: %u.%u%% busy, %u us (max %u us), waited max %u us, %u windows, %u dropped",
+				names[ix], permille / 10, permille % 10, s.lastUs, s.maxUs, s.waitUsMax, s.items, s.dropped);
+		busyAtReport[ix] = s.busyUs;
+	}
+	LOG_INF("%u windows: latency max %u us, %u errors, %u/%u windows / %u/%u features in use", windows,
+			latencyUsMax, errors, (unsigned int)System::mWindows.InUse(),
+			(unsigned int)Pipeline::Windows::Capacity(), (unsigned int)System::mFeatures.InUse(),
+			(unsigned int)Pipeline::FeatureVectors::Capacity());
+	reportedAt = now;
+	latencyUsMax = 0;
+	errors = 0;
+}
+
+void Service::Inference::Handle(const uint8_t arg[]) {
+    /**
+     * Handle arg packet.
+     */
+    switch(arg[0])
+    {
+		case CMD_INFERENCE_FEATURES:
+		{
+			Classify();
+		}; break;
+        default:
+        {
+            LOG_WRN("[Service::%s]::%s():\t%x.\tIgnored.", mName, __func__, arg[0]);
+            break;
+        }
+    };
+}
+
+/**
+ * Build the static members on the RTOS::ActiveObject
+ */
+namespace Service
+{
+    using                       _Inference = RTOS::ActiveObject<Service::Inference>;
+
+    template <>
+    const char               	_Inference::mName[] =  "Inference";
+    template <>
+    uint8_t                     _Inference::mCountLoops = 0;
+    template <>
+    const uint8_t               _Inference::mInputQueueItemLength = 16;
+    template <>
+    const uint8_t               _Inference::mInputQueueItemSize = sizeof(uint16_t);
+    template <>
+    const size_t                _Inference::mInputQueueSizeBytes =
+                                        RTOS::ActiveObject<Service::Inference>::mInputQueueItemLength
+                                        * RTOS::ActiveObject<Service::Inference>::mInputQueueItemSize;
+    template <>
+    char                        _Inference::mInputQueueAllocation[
+                                        RTOS::ActiveObject<Service::Inference>::mInputQueueSizeBytes
+                                    ] = { 0 };
+    template <>
+    RTOS::QueueHandle_t         _Inference::mInputQueue = RTOS::Hal::QueueCreate(
+                                        RTOS::ActiveObject<Service::Inference>::mInputQueueItemLength,
+                                        RTOS::ActiveObject<Service::Inference>::mInputQueueItemSize,
+                                        RTOS::ActiveObject<Service::Inference>::mInputQueueAllocation
+                                    );
+    template <>
+    uint8_t                     _Inference::mReceivedMsg[
+                                        RTOS::ActiveObject<Service::Inference>::mInputQueueItemLength
+                                    ] = { 0 };
+
+
+    namespace {
+    // Tensor arena is static, the stack holds the interpreter's locals
+    ZPP_KERNEL_STACK_DEFINE(inferencestack, 4096);
+    template <>
+    zpp::thread_data            _Inference::mTaskControlBlock = zpp::thread_data();
+    template <>
+    zpp::thread                 _Inference::mHandle = zpp::thread(
+                                        mTaskControlBlock,
+                                        Service::inferencestack(),
+                                        RTOS::cThreadAttributes,
+                                        Service::_Inference::Run
+                                    );
+    }
+}
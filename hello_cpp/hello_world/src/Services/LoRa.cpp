@@ -17,7 +17,7 @@ void Service::LoRa::Handle(const uint8_t arg[]) {
         default:
         {
             LOG_INF("[Service::%s]::%s():\t%x.\tNYI.", mName, __func__, arg[0]);    
-            LOG_HEXDUMP_INF(arg, 5, "\t\t\t LoRa msg Buffer values.");
+            LOG_HEXDUMP_DBG(arg, 5, "\t\t\t LoRa msg Buffer values.");
             break;
         }
     };
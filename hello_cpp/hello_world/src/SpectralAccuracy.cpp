@@ -0,0 +1,53 @@
+/*
+ * native_sim harness for the fixed-point spectral features (EIDSP_USE_FIXED_POINT_SPECTRAL):
+ * runs every recorded window through the fixed-point and the float features
+ * (EImpulse::CompareFixedPoint()) and prints the totals. Needs no hub and no sh2 stack.
+ *
+ *     west build -b native_sim -t run -- -DSPECTRAL_ACCURACY_WINDOWS=<windows>.f32
+ */
+#if SPECTRAL_ACCURACY
+
+#include <Drivers/EdgeImpulse.hpp>
+
+#include <zephyr/kernel.h>
+#include <cstring>
+
+#define LOG_LEVEL 3
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(SpectralAccuracy);
+
+namespace {
+	constexpr size_t cWindowBytes = EImpulse::cWindowFloats * sizeof(float);
+
+	// Little-endian float32 windows, embedded by CMakeLists.txt
+	const uint8_t recorded[] = {
+	#include <spectral_accuracy_windows.inc>
+	};
+
+	float window[EImpulse::cWindowFloats];
+}
+
+static void spectral_accuracy_task(void *, void *, void *)
+{
+	if (sizeof(recorded) % cWindowBytes != 0) {
+		LOG_ERR("%s: %u bytes are not whole windows of %u", __func__,
+			(unsigned int)sizeof(recorded), (unsigned int)cWindowBytes);
+		return;
+	}
+
+	for (size_t offset = 0; offset < sizeof(recorded); offset += cWindowBytes) {
+		// The byte array has no float alignment; native_sim is little endian like the file
+		memcpy(window, &recorded[offset], cWindowBytes);
+		if (EImpulse::CompareFixedPoint(window) != 0) {
+			LOG_ERR("%s: window %u: the DSP block is not spectral analysis (FFT, v1)", __func__,
+				(unsigned int)(offset / cWindowBytes));
+			return;
+		}
+	}
+	EImpulse::PrintFixedPointAccuracy();
+}
+
+K_THREAD_DEFINE(spectral_accuracy_task_id, 4096, spectral_accuracy_task, NULL, NULL, NULL,
+		7, 0, 0);
+
+#endif /* SPECTRAL_ACCURACY */
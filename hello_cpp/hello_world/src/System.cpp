@@ -1,10 +1,12 @@
 #include <System.hpp>
 
+// Before the services: their threads may start running while the rest is still constructed
+Pipeline::Windows System::mWindows;
+Pipeline::FeatureVectors System::mFeatures;
+
 // Check if needed. May be removed.
 // TODO: Check if the constructors are being prbly called without constexpr.
 std::vector<std::variant<_REGISTERED_SERVICES>> 
     System::mSystemServicesRegistered = {
         REGISTERED_SERVICES
-    };
-
-RTOS::HAL::RingBuffer<float,153*16> System::mDSPDataRingBuffer = RTOS::HAL::RingBuffer<float,153*16>();
\ No newline at end of file
+    };
\ No newline at end of file
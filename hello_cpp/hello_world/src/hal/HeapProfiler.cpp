@@ -0,0 +1,529 @@
+#define LOG_LEVEL 3
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(HeapProfiler);
+
+#include <hal/HeapProfiler.hpp>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/sys_heap.h>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(CONFIG_ARCH_STACKWALK)
+#include <zephyr/arch/arch_interface.h>
+#if defined(CONFIG_RISCV) && !defined(CONFIG_FRAME_POINTER)
+#error "HeapProfiler: arch_stack_walk() needs CONFIG_FRAME_POINTER=y on RISC-V"
+#endif
+#endif
+
+#if defined(CONFIG_HEAP_MEM_POOL_SIZE) && (CONFIG_HEAP_MEM_POOL_SIZE > 0)
+extern struct k_heap _system_heap;
+#endif
+
+// The libc arena is a static sys_heap inside malloc.c: AttachMalloc() finds it among the heaps
+// sys_heap_init() saved, by the address of a block malloc() returns
+#if defined(CONFIG_COMMON_LIBC_MALLOC_ARENA_SIZE) && (CONFIG_COMMON_LIBC_MALLOC_ARENA_SIZE != 0) && \
+    defined(CONFIG_SYS_HEAP_ARRAY_SIZE) && (CONFIG_SYS_HEAP_ARRAY_SIZE > 0)
+#define HEAP_PROFILER_LIBC_ARENA 1
+#endif
+
+namespace {
+
+struct Block {
+    void *mem;
+    size_t bytes;
+    uint8_t site;
+};
+
+struct Walk {
+    uintptr_t frames[RTOS::HeapProfiler::cWalkFrames];
+    size_t seen;
+};
+
+// A probe's call into the allocator returns this close to the probe's entry
+constexpr uintptr_t cProbeBytes = 64;
+
+// Listeners run under the heap's own lock, possibly from any thread: keep them short and
+// allocation free, everything lives in these tables.
+struct k_spinlock sLock;
+struct heap_listener sAllocListeners[RTOS::HeapProfiler::cMaxHeaps];
+struct heap_listener sFreeListeners[RTOS::HeapProfiler::cMaxHeaps];
+size_t sHeaps;
+RTOS::HeapProfiler::Site sSites[RTOS::HeapProfiler::cMaxSites];
+size_t sSiteCount;
+Block sBlocks[RTOS::HeapProfiler::cMaxBlocks];
+uint32_t sDropped;
+
+// Return addresses inside the allocator chain, learnt by Calibrate()
+uintptr_t sAllocatorFrames[RTOS::HeapProfiler::cAllocatorFrames];
+size_t sAllocatorFrameCount;
+const struct k_thread *sCalibrating;
+uintptr_t sProbe;
+void *volatile sProbeBlock;
+struct sys_heap *sMallocHeap;
+
+#if defined(CONFIG_ARCH_STACKWALK)
+bool CollectFrame(void *cookie, unsigned long addr)
+{
+    Walk *walk = static_cast<Walk *>(cookie);
+
+    walk->frames[walk->seen++] = addr;
+    return walk->seen < RTOS::HeapProfiler::cWalkFrames;
+}
+#endif
+
+// One call site for the walk, so the frames it leaves on the stack are the same ones while
+// calibrating and while profiling
+void CaptureSite(Walk &walk)
+{
+    memset(&walk, 0, sizeof(walk));
+#if defined(CONFIG_ARCH_STACKWALK)
+    if (!k_is_in_isr()) {
+        arch_stack_walk(CollectFrame, &walk, k_current_get(), nullptr);
+    }
+#endif
+}
+
+bool IsAllocatorFrame(uintptr_t addr)
+{
+    for (size_t i = 0; i < sAllocatorFrameCount; ++i) {
+        if (sAllocatorFrames[i] == addr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Everything below the frame returning into the probe belongs to the allocator. Lock held.
+void Learn(const Walk &walk)
+{
+    size_t probe = 0;
+
+    while (probe < walk.seen && (walk.frames[probe] < sProbe || walk.frames[probe] >= sProbe + cProbeBytes)) {
+        probe++;
+    }
+    for (size_t i = 0; probe < walk.seen && i < probe; ++i) {
+        if (!IsAllocatorFrame(walk.frames[i]) && sAllocatorFrameCount < RTOS::HeapProfiler::cAllocatorFrames) {
+            sAllocatorFrames[sAllocatorFrameCount++] = walk.frames[i];
+        }
+    }
+}
+
+// The first cFrames return addresses above the allocator chain. Lock held.
+void SiteFrames(const Walk &walk, uintptr_t (&frames)[RTOS::HeapProfiler::cFrames])
+{
+    size_t i = 0;
+
+    memset(frames, 0, sizeof(frames));
+    while (i < walk.seen && IsAllocatorFrame(walk.frames[i])) {
+        i++;
+    }
+    for (size_t n = 0; i < walk.seen && n < RTOS::HeapProfiler::cFrames; ++i, ++n) {
+        frames[n] = walk.frames[i];
+    }
+}
+
+// Probes: one allocator entry point each, not a tail call (the result is stored after it)
+__noinline void ProbeHeapAlloc(struct k_heap *heap)
+{
+    sProbeBlock = k_heap_alloc(heap, 1, K_NO_WAIT);
+}
+
+__noinline void ProbeHeapAlignedAlloc(struct k_heap *heap)
+{
+    sProbeBlock = k_heap_aligned_alloc(heap, 64, 1, K_NO_WAIT);
+}
+
+#if defined(CONFIG_HEAP_MEM_POOL_SIZE) && (CONFIG_HEAP_MEM_POOL_SIZE > 0)
+__noinline void ProbeMalloc(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = k_malloc(1);
+}
+
+__noinline void ProbeCalloc(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = k_calloc(1, 1);
+}
+
+__noinline void ProbeAlignedAlloc(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = k_aligned_alloc(64, 1);
+}
+#endif
+
+#if defined(HEAP_PROFILER_LIBC_ARENA)
+__noinline void ProbeLibcMalloc(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = malloc(1);
+}
+
+__noinline void ProbeLibcCalloc(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = calloc(1, 1);
+}
+
+__noinline void ProbeLibcRealloc(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = realloc(nullptr, 1);
+}
+
+__noinline void ProbeLibcAlignedAlloc(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = aligned_alloc(64, 64);
+}
+
+// std::vector, std::string and new expressions
+__noinline void ProbeNew(struct k_heap *heap)
+{
+    ARG_UNUSED(heap);
+    sProbeBlock = ::operator new(1);
+}
+#endif
+
+// Which allocator a probe goes through, and so how its block is given back
+enum class Entry {
+    KHeap,      /**< k_heap_alloc() family on the heap being calibrated, k_heap_free() */
+    Kernel,     /**< k_malloc() family, only for the system heap, k_free() */
+    Libc,       /**< malloc() family, only for the libc arena, free() */
+    New,        /**< operator new, only for the libc arena, operator delete */
+};
+
+// Learns the frames of every entry point that allocates from heap. kHeap is its k_heap,
+// nullptr for a bare sys_heap.
+void Calibrate(struct sys_heap *heap, struct k_heap *kHeap)
+{
+#if defined(CONFIG_ARCH_STACKWALK)
+    struct Probe {
+        void (*fn)(struct k_heap *);
+        Entry entry;
+    };
+    const Probe probes[] = {
+        {ProbeHeapAlloc, Entry::KHeap},
+        {ProbeHeapAlignedAlloc, Entry::KHeap},
+#if defined(CONFIG_HEAP_MEM_POOL_SIZE) && (CONFIG_HEAP_MEM_POOL_SIZE > 0)
+        {ProbeMalloc, Entry::Kernel},
+        {ProbeCalloc, Entry::Kernel},
+        {ProbeAlignedAlloc, Entry::Kernel},
+#endif
+#if defined(HEAP_PROFILER_LIBC_ARENA)
+        {ProbeLibcMalloc, Entry::Libc},
+        {ProbeLibcCalloc, Entry::Libc},
+        {ProbeLibcRealloc, Entry::Libc},
+        {ProbeLibcAlignedAlloc, Entry::Libc},
+        {ProbeNew, Entry::New},
+#endif
+    };
+
+    for (const Probe &probe : probes) {
+        bool applies = false;
+
+        switch (probe.entry) {
+        case Entry::KHeap:
+            applies = kHeap != nullptr;
+            break;
+        case Entry::Kernel:
+#if defined(CONFIG_HEAP_MEM_POOL_SIZE) && (CONFIG_HEAP_MEM_POOL_SIZE > 0)
+            applies = kHeap == &_system_heap;
+#endif
+            break;
+        case Entry::Libc:
+        case Entry::New:
+            applies = heap == sMallocHeap;
+            break;
+        }
+        if (!applies) {
+            continue;
+        }
+
+        sProbe = (uintptr_t)probe.fn & ~(uintptr_t)1;   /* no Thumb bit */
+        sCalibrating = k_current_get();
+        probe.fn(kHeap);
+        sCalibrating = nullptr;
+
+        if (sProbeBlock == nullptr) {
+            continue;
+        }
+        switch (probe.entry) {
+        case Entry::KHeap:
+            k_heap_free(kHeap, sProbeBlock);
+            break;
+        case Entry::Kernel:
+            k_free(sProbeBlock);
+            break;
+        case Entry::Libc:
+            free(sProbeBlock);
+            break;
+        case Entry::New:
+            ::operator delete(sProbeBlock);
+            break;
+        }
+        sProbeBlock = nullptr;
+    }
+    LOG_INF("heap %p: %u allocator frames learnt", (void *)heap, (unsigned int)sAllocatorFrameCount);
+#else
+    ARG_UNUSED(heap);
+    ARG_UNUSED(kHeap);
+#endif
+}
+
+#if defined(HEAP_PROFILER_LIBC_ARENA)
+// The saved heap whose memory holds mem
+struct sys_heap *FindHeap(const void *mem)
+{
+    struct sys_heap **heaps;
+    int count = sys_heap_array_get(&heaps);
+
+    for (int i = 0; i < count; ++i) {
+        uintptr_t start = (uintptr_t)heaps[i]->init_mem;
+
+        if ((uintptr_t)mem >= start && (uintptr_t)mem < start + heaps[i]->init_bytes) {
+            return heaps[i];
+        }
+    }
+    return nullptr;
+}
+#endif
+
+// Returns the site index or -1 when the table is full. Lock held.
+int FindOrAddSite(const uintptr_t (&frames)[RTOS::HeapProfiler::cFrames], const struct k_thread *thread)
+{
+    for (size_t i = 0; i < sSiteCount; ++i) {
+        if (sSites[i].thread == thread &&
+            memcmp(sSites[i].frames, frames, sizeof(frames)) == 0) {
+            return i;
+        }
+    }
+    if (sSiteCount == RTOS::HeapProfiler::cMaxSites) {
+        return -1;
+    }
+
+    RTOS::HeapProfiler::Site &site = sSites[sSiteCount];
+
+    memset(&site, 0, sizeof(site));
+    memcpy(site.frames, frames, sizeof(frames));
+    site.thread = thread;
+    return sSiteCount++;
+}
+
+// Share of the address range spanned by a site's live blocks that is not its own:
+// high values mean a few long lived blocks pinned far apart, splitting the free space.
+unsigned int Scatter(size_t site)
+{
+    uintptr_t lo = UINTPTR_MAX;
+    uintptr_t hi = 0;
+
+    for (const Block &b : sBlocks) {
+        if (b.mem != nullptr && b.site == site) {
+            lo = MIN(lo, (uintptr_t)b.mem);
+            hi = MAX(hi, (uintptr_t)b.mem + b.bytes);
+        }
+    }
+    if (hi <= lo || sSites[site].liveBytes >= hi - lo) {
+        return 0;
+    }
+    return 100U - (unsigned int)((sSites[site].liveBytes * 100U) / (hi - lo));
+}
+
+} // namespace
+
+bool RTOS::HeapProfiler::Attach(struct sys_heap *heap)
+{
+    const uintptr_t heapId = HEAP_ID_FROM_POINTER(heap);
+
+    k_spinlock_key_t key = k_spin_lock(&sLock);
+
+    for (size_t i = 0; i < sHeaps; ++i) {
+        if (sAllocListeners[i].heap_id == heapId) {
+            k_spin_unlock(&sLock, key);
+            return true;
+        }
+    }
+    if (sHeaps == cMaxHeaps) {
+        k_spin_unlock(&sLock, key);
+        return false;
+    }
+
+    struct heap_listener *onAlloc = &sAllocListeners[sHeaps];
+    struct heap_listener *onFree = &sFreeListeners[sHeaps];
+
+    sHeaps++;
+    k_spin_unlock(&sLock, key);
+
+    onAlloc->heap_id = heapId;
+    onAlloc->event = HEAP_ALLOC;
+    onAlloc->alloc_cb = OnAlloc;
+    onFree->heap_id = heapId;
+    onFree->event = HEAP_FREE;
+    onFree->free_cb = OnFree;
+
+    heap_listener_register(onAlloc);
+    heap_listener_register(onFree);
+    return true;
+}
+
+bool RTOS::HeapProfiler::Attach(struct k_heap *heap)
+{
+    if (!Attach(&heap->heap)) {
+        return false;
+    }
+    Calibrate(&heap->heap, heap);
+    return true;
+}
+
+bool RTOS::HeapProfiler::AttachMalloc()
+{
+#if defined(HEAP_PROFILER_LIBC_ARENA)
+    void *block = malloc(1);
+    struct sys_heap *heap = FindHeap(block);
+
+    free(block);
+    if (heap == nullptr) {
+        LOG_ERR("%s: libc arena not among the %u saved heaps, raise CONFIG_SYS_HEAP_ARRAY_SIZE",
+            __func__, (unsigned int)CONFIG_SYS_HEAP_ARRAY_SIZE);
+        return false;
+    }
+    if (!Attach(heap)) {
+        return false;
+    }
+    sMallocHeap = heap;
+    Calibrate(heap, nullptr);
+    return true;
+#else
+    LOG_ERR("%s: needs CONFIG_COMMON_LIBC_MALLOC_ARENA_SIZE != 0 and CONFIG_SYS_HEAP_ARRAY_SIZE > 0",
+        __func__);
+    return false;
+#endif
+}
+
+void RTOS::HeapProfiler::OnAlloc(uintptr_t heapId, void *mem, size_t bytes)
+{
+    ARG_UNUSED(heapId);
+
+    Walk walk;
+    const struct k_thread *thread = k_is_in_isr() ? nullptr : k_current_get();
+
+    CaptureSite(walk);
+
+    k_spinlock_key_t key = k_spin_lock(&sLock);
+
+    if (sCalibrating != nullptr && thread == sCalibrating) {
+        Learn(walk);
+        k_spin_unlock(&sLock, key);
+        return;
+    }
+
+    uintptr_t frames[cFrames];
+
+    SiteFrames(walk, frames);
+
+    int index = FindOrAddSite(frames, thread);
+    Block *slot = nullptr;
+
+    for (Block &b : sBlocks) {
+        if (b.mem == nullptr) {
+            slot = &b;
+            break;
+        }
+    }
+    if (index < 0 || slot == nullptr) {
+        sDropped++;
+        k_spin_unlock(&sLock, key);
+        return;
+    }
+
+    Site &site = sSites[index];
+
+    slot->mem = mem;
+    slot->bytes = bytes;
+    slot->site = (uint8_t)index;
+    site.allocs++;
+    site.liveBlocks++;
+    site.liveBytes += bytes;
+    site.peakBytes = MAX(site.peakBytes, site.liveBytes);
+    k_spin_unlock(&sLock, key);
+}
+
+void RTOS::HeapProfiler::OnFree(uintptr_t heapId, void *mem, size_t bytes)
+{
+    ARG_UNUSED(heapId);
+    ARG_UNUSED(bytes);
+
+    k_spinlock_key_t key = k_spin_lock(&sLock);
+
+    for (Block &b : sBlocks) {
+        if (b.mem == mem) {
+            Site &site = sSites[b.site];
+
+            site.frees++;
+            site.liveBlocks--;
+            site.liveBytes -= b.bytes;
+            b.mem = nullptr;
+            break;
+        }
+    }
+    k_spin_unlock(&sLock, key);
+}
+
+void RTOS::HeapProfiler::Dump()
+{
+    Site sites[cMaxSites];
+    unsigned int scatter[cMaxSites];
+    size_t count;
+    uint32_t dropped;
+
+    // Snapshot first, log after: the log backend may allocate itself
+    k_spinlock_key_t key = k_spin_lock(&sLock);
+    count = sSiteCount;
+    dropped = sDropped;
+    memcpy(sites, sSites, count * sizeof(Site));
+    for (size_t i = 0; i < count; ++i) {
+        scatter[i] = Scatter(i);
+    }
+    k_spin_unlock(&sLock, key);
+
+    LOG_INF("heap sites: %u, untracked allocations: %u", (unsigned int)count, dropped);
+    for (size_t i = 0; i < count; ++i) {
+        const Site &s = sites[i];
+
+        LOG_INF("#%u %s live %u B/%u blk peak %u B alloc %u free %u scatter %u%% @ %p %p %p %p",
+            (unsigned int)i, s.thread ? k_thread_name_get((k_tid_t)s.thread) : "isr",
+            (unsigned int)s.liveBytes, s.liveBlocks, (unsigned int)s.peakBytes, s.allocs, s.frees,
+            scatter[i], (void *)s.frames[0], (void *)s.frames[1], (void *)s.frames[2],
+            (void *)s.frames[3]);
+    }
+
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS)
+    for (size_t i = 0; i < sHeaps; ++i) {
+        struct sys_memory_stats stats;
+
+        if (sys_heap_runtime_stats_get((struct sys_heap *)sAllocListeners[i].heap_id, &stats) == 0) {
+            LOG_INF("heap %p: allocated %u B, free %u B, max allocated %u B",
+                (void *)sAllocListeners[i].heap_id, (unsigned int)stats.allocated_bytes,
+                (unsigned int)stats.free_bytes, (unsigned int)stats.max_allocated_bytes);
+        }
+    }
+#endif
+}
+
+void RTOS::HeapProfiler::Reset()
+{
+    k_spinlock_key_t key = k_spin_lock(&sLock);
+
+    memset(sSites, 0, sizeof(sSites));
+    memset(sBlocks, 0, sizeof(sBlocks));
+    sSiteCount = 0;
+    sDropped = 0;
+    k_spin_unlock(&sLock, key);
+}
+
+uint32_t RTOS::HeapProfiler::Dropped()
+{
+    return sDropped;
+}
@@ -7,6 +7,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <zephyr/sys/util.h>
 #include <zephyr/logging/log.h>
@@ -16,9 +17,11 @@ LOG_MODULE_REGISTER(logging_blog, LOG_LEVEL_DBG);
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/heap_listener.h>
 #include <zephyr/zbus/zbus.h>
+#include <hal/HeapProfiler.hpp>
+#include <hal/SharedChannel.hpp>
+#include <hal/LatestValue.hpp>
 
-extern struct sys_heap _system_heap;
-static size_t total_allocated;
+extern struct k_heap _system_heap;
 
 
 // gdbstub test debugging instructions
@@ -70,6 +73,49 @@ ZBUS_CHAN_DEFINE(controls_chan,  /* Name */
 	ZBUS_MSG_INIT(.op = 0, .payload = {0})  /* Initial value */
 );
 
+/* Large frames: zbus only carries the handle, the payload stays in imu_frames' slab */
+#define IMU_FRAME_BYTES 1024
+ZBUS_CHAN_DEFINE(imu_frame_chan,  /* Name */
+	RTOS::SharedFrame, /* Message type */
+
+	NULL, /* Validator */
+	NULL, /* User data */
+	ZBUS_OBSERVERS(frame_reader_lis), /* observers: SharedReader listeners only */
+	ZBUS_MSG_INIT(.block = nullptr)  /* Initial value */
+);
+static RTOS::SharedChannel<IMU_FRAME_BYTES, 3> imu_frames(&imu_frame_chan);
+
+
+#if defined(CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_POOL_ISOLATION)
+/*
+ * One fixed pool per channel, each buffer exactly one message big. A publication takes one
+ * buffer plus one clone per msg subscriber, so N subscribers that may each hold
+ * MSG_POOL_DEPTH undelivered messages need 1 + N * MSG_POOL_DEPTH buffers. Publishing never
+ * touches the heap and a slow subscriber on one channel cannot starve the other.
+ */
+#define MSG_POOL_DEPTH 2
+#define MSG_POOL_COUNT(_subs) (1 + (_subs) * MSG_POOL_DEPTH)
+
+/* bar_msg_sub1..5 + LoRa and HardwareTimers, the pipeline stages do not subscribe */
+NET_BUF_POOL_FIXED_DEFINE(acc_data_pool, MSG_POOL_COUNT(5 + 2), sizeof(struct acc_msg),
+			  sizeof(struct zbus_channel *), NULL);
+/* LoRa and HardwareTimers */
+NET_BUF_POOL_FIXED_DEFINE(controls_pool, MSG_POOL_COUNT(2), sizeof(struct controls_msg),
+			  sizeof(struct zbus_channel *), NULL);
+
+static void msg_pools_report(void)
+{
+#if defined(CONFIG_NET_BUF_POOL_USAGE)
+	struct net_buf_pool *pools[] = {&acc_data_pool, &controls_pool};
+
+	for (struct net_buf_pool *pool : pools) {
+		LOG_INF("msg pool %s: %u/%u in use, high-water %u", pool->name,
+			(unsigned int)(pool->pool_size - atomic_get(&pool->avail_count)),
+			(unsigned int)pool->pool_size, (unsigned int)pool->max_used);
+	}
+#endif /* CONFIG_NET_BUF_POOL_USAGE */
+}
+#endif /* CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_POOL_ISOLATION */
 
 ZBUS_MSG_SUBSCRIBER_DEFINE(bar_msg_sub1);
 ZBUS_MSG_SUBSCRIBER_DEFINE(bar_msg_sub2);
@@ -78,7 +124,6 @@ ZBUS_MSG_SUBSCRIBER_DEFINE(bar_msg_sub4);
 ZBUS_MSG_SUBSCRIBER_DEFINE(bar_msg_sub5);
 
 ZBUS_SUBSCRIBER_DEFINE(bar_sub1, 4);
-ZBUS_SUBSCRIBER_DEFINE(bar_sub2, 4);
 
 static void msg_subscriber_task(void *sub)
 {
@@ -148,10 +193,54 @@ static void subscriber_task(void *sub)
 
 K_THREAD_DEFINE(subscriber_task_id17, CONFIG_MAIN_STACK_SIZE, subscriber_task, &bar_sub1, NULL,
 	NULL, 2, 0, 0);
-K_THREAD_DEFINE(subscriber_task_id18, CONFIG_MAIN_STACK_SIZE, subscriber_task, &bar_sub2, NULL,
+/*
+ * Conflating view of acc_data_chan: the listener copies every publication into a seqlock
+ * slot from the publisher's context, the slow reader below only ever takes the newest one.
+ * No zbus queue to back up and no zbus_chan_read() holding the channel against the publisher.
+ */
+static RTOS::LatestValue<struct acc_msg> acc_latest;
+
+static void acc_latest_listener(const struct zbus_channel *chan)
+{
+	acc_latest.Publish(*static_cast<const struct acc_msg *>(zbus_chan_const_msg(chan)));
+}
+
+ZBUS_LISTENER_DEFINE(acc_latest_lis, acc_latest_listener);
+
+static void latest_subscriber_task(void *, void *, void *)
+{
+	RTOS::LatestValue<struct acc_msg>::Reader reader;
+	struct acc_msg acc;
+
+	acc_latest.Subscribe(reader);
+	while (true) {
+		if (acc_latest.Wait(reader, acc, K_FOREVER)) {
+			LOG_INF("From latest value reader -> Acc x=%d, y=%d, z=%d", acc.x, acc.y, acc.z);
+		}
+	}
+}
+
+K_THREAD_DEFINE(subscriber_task_id18, CONFIG_MAIN_STACK_SIZE, latest_subscriber_task, NULL, NULL,
 	NULL, 4, 0, 0);
 
-ZBUS_CHAN_ADD_OBS(acc_data_chan, bar_sub2, 3);
+SHARED_CHANNEL_READER_DEFINE(frame_reader, 2);
+
+static void frame_subscriber_task(void *, void *, void *)
+{
+	RTOS::SharedFrame frame;
+
+	while (frame_reader.Wait(frame, K_FOREVER)) {
+		LOG_DBG("From shared reader -> frame %u bytes, first %02x, %u dropped",
+			(unsigned int)frame.Length(), frame.Data()[0],
+			(unsigned int)frame_reader.Dropped());
+		frame.Release();
+	}
+}
+
+K_THREAD_DEFINE(frame_subscriber_task_id, STACK_SIZE_TEST, frame_subscriber_task, NULL,
+		NULL, NULL, 3, 0, 0);
+
+ZBUS_CHAN_ADD_OBS(acc_data_chan, acc_latest_lis, 3);
 ZBUS_CHAN_ADD_OBS(acc_data_chan, bar_msg_sub5, 3);
 
 // Kalman Kinematic Arbiter:
@@ -166,45 +255,24 @@ extern "C" {
 	static struct acc_msg acc = {.x = 1, .y = 10, .z = 100};
 	static struct controls_msg ctrl = {.op = 1, .payload = {0}};
 
-	void on_heap_alloc(uintptr_t heap_id, void *mem, size_t bytes)
-	{
-		total_allocated += bytes;
-		LOG_INF(" AL Memory allocated %u bytes. Total allocated %u bytes", (unsigned int)bytes,
-			(unsigned int)total_allocated);
-	}
-	
-	void on_heap_free(uintptr_t heap_id, void *mem, size_t bytes)
-	{
-		total_allocated -= bytes;
-		LOG_INF(" FR Memory freed %u bytes. Total allocated %u bytes", (unsigned int)bytes,
-			(unsigned int)total_allocated);
-	}
-	
-	#if defined(CONFIG_ZBUS_MSG_SUBSCRIBER_BUF_ALLOC_DYNAMIC)
-	
-	// HEAP_LISTENER_ALLOC_DEFINE(my_heap_listener_alloc, HEAP_ID_FROM_POINTER(&_system_heap),
-	// 			   on_heap_alloc);
-	
-	// HEAP_LISTENER_FREE_DEFINE(my_heap_listener_free, HEAP_ID_FROM_POINTER(&_system_heap), on_heap_free);
-	
-	#endif /* CONFIG_ZBUS_MSG_SUBSCRIBER_BUF_ALLOC_DYNAMIC */
 	#define MAX_INT_K 1024
+	#define MEM_REPORT_EVERY 100	/* main loop iterations, ~10 s */
 	static int count = 0;
 	
 	int main(void)
 	{
 
-		total_allocated = 0;
 	#if defined(CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_POOL_ISOLATION)
-		// zbus_chan_set_msg_sub_pool(&acc_data_chan, &isolated_pool);
+		zbus_chan_set_msg_sub_pool(&acc_data_chan, &acc_data_pool);
+		zbus_chan_set_msg_sub_pool(&controls_chan, &controls_pool);
 	#endif
 	
-	#if defined(CONFIG_ZBUS_MSG_SUBSCRIBER_BUF_ALLOC_DYNAMIC)
-	
-		// heap_listener_register(&my_heap_listener_alloc);
-		// heap_listener_register(&my_heap_listener_free);
-	
-	#endif /* CONFIG_ZBUS_MSG_SUBSCRIBER_BUF_ALLOC_DYNAMIC */
+	#if defined(CONFIG_SYS_HEAP_LISTENER)
+		/* k_malloc users, runtime zbus observer nodes */
+		RTOS::HeapProfiler::Attach(&_system_heap);
+		/* malloc, operator new, std::vector and ei_malloc: libc's own arena */
+		RTOS::HeapProfiler::AttachMalloc();
+	#endif /* CONFIG_SYS_HEAP_LISTENER */
 
 		LOG_INF("%s():enter", __func__);
 
@@ -223,6 +291,20 @@ extern "C" {
 				ctrl.payload[i] = count;
 			}
 			Service::LoRa::Send((uint8_t*)&count);
+
+			RTOS::SharedBlock *frame = imu_frames.Acquire(K_NO_WAIT);
+			if (frame != nullptr) {
+				memset(frame->Data(), (uint8_t)count, IMU_FRAME_BYTES);
+				imu_frames.Publish(frame, IMU_FRAME_BYTES, K_NO_WAIT);
+			}
+			if ((count / 63) % MEM_REPORT_EVERY == 0) {
+		#if defined(CONFIG_SYS_HEAP_LISTENER)
+				RTOS::HeapProfiler::Dump();
+		#endif /* CONFIG_SYS_HEAP_LISTENER */
+		#if defined(CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_POOL_ISOLATION)
+				msg_pools_report();
+		#endif /* CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_POOL_ISOLATION */
+			}
 			// __ASSERT(var, "False forced assert in function: %s()", __FUNCTION__, 0);
 		}
 	
@@ -0,0 +1,410 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* ===================== lora_link.c ===================== */
+
+#include "lora_link.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(lora_link, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* One retransmit buffer slot, indexed by seq % LORA_LINK_RETX_DEPTH */
+struct retx_slot {
+	bool in_use; /* sent and not acked yet */
+	uint8_t retries;
+	uint8_t len; /* full frame length, header included */
+	uint16_t seq;
+	uint8_t frame[LORA_LINK_HDR_LEN + LORA_LINK_MAX_PAYLOAD];
+};
+
+/* Receiver-side state for one sending node */
+struct peer_state {
+	bool valid;
+	bool ack_pending;
+	uint8_t node;
+	uint16_t last_seq; /* highest sequence received */
+	uint32_t bitmap;   /* bit i: last_seq - 1 - i received */
+	uint32_t received;
+	uint32_t expected;
+	uint32_t duplicates;
+	uint32_t bytes;
+};
+
+static const struct device *_dev;
+static struct lora_modem_config _config;
+static uint8_t _node_id;
+static uint16_t _next_seq;
+static struct k_spinlock _lock;
+
+static struct retx_slot _retx[LORA_LINK_RETX_DEPTH];
+static struct peer_state _peers[LORA_LINK_MAX_PEERS];
+static struct lora_link_stats _stats; /* under _lock, lora_link_get_stats() reads it anywhere */
+
+static inline void put_hdr(uint8_t *buf, uint8_t type, uint16_t seq)
+{
+	buf[0] = (LORA_LINK_VERSION << 4) | (type & 0x0F);
+	buf[1] = _node_id;
+	sys_put_le16(seq, &buf[2]);
+}
+
+/* Switch the modem between TX and RX only when the direction changes */
+static int set_tx(bool tx)
+{
+	if (_config.tx == tx) {
+		return 0;
+	}
+	_config.tx = tx;
+	return lora_config(_dev, &_config);
+}
+
+int lora_link_init(const struct device *lora_dev, const struct lora_modem_config *config,
+		   uint8_t node_id)
+{
+	if (lora_dev == NULL || config == NULL) {
+		return -EINVAL;
+	}
+
+	_dev = lora_dev;
+	_config = *config;
+	_node_id = node_id;
+	_next_seq = 0;
+	memset(_retx, 0, sizeof(_retx));
+	memset(_peers, 0, sizeof(_peers));
+	memset(&_stats, 0, sizeof(_stats));
+	_stats.start_ms = k_uptime_get();
+
+	return lora_config(_dev, &_config);
+}
+
+int lora_link_send(const uint8_t *payload, uint8_t len, bool ack_req)
+{
+	if (len > LORA_LINK_MAX_PAYLOAD) {
+		return -EMSGSIZE;
+	}
+
+	uint16_t seq = _next_seq++;
+	struct retx_slot *slot = &_retx[seq % LORA_LINK_RETX_DEPTH];
+	bool expired = slot->in_use; /* oldest frame falls out of the buffer without ever being acked */
+
+	put_hdr(slot->frame, ack_req ? LORA_LINK_TYPE_DATA_ACKREQ : LORA_LINK_TYPE_DATA, seq);
+	memcpy(&slot->frame[LORA_LINK_HDR_LEN], payload, len);
+	slot->len = LORA_LINK_HDR_LEN + len;
+	slot->seq = seq;
+	slot->retries = 0;
+	slot->in_use = true;
+
+	int ret = set_tx(true);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = lora_send(_dev, slot->frame, slot->len);
+
+	k_spinlock_key_t key = k_spin_lock(&_lock);
+
+	_stats.tx_expired += expired ? 1 : 0;
+	if (ret == 0) {
+		_stats.tx_frames++;
+		_stats.tx_bytes += len;
+	}
+	k_spin_unlock(&_lock, key);
+	return ret;
+}
+
+static void handle_ack(uint16_t base, uint32_t bitmap)
+{
+	/* counted here, added to _stats once: lora_send() below may block */
+	uint32_t acked_frames = 0, acked_bytes = 0, expired = 0, retransmits = 0;
+
+	for (size_t i = 0; i < LORA_LINK_RETX_DEPTH; ++i) {
+		struct retx_slot *slot = &_retx[i];
+		int16_t d;
+		bool acked;
+
+		if (!slot->in_use) {
+			continue;
+		}
+
+		d = (int16_t)(base - slot->seq);
+		if (d < 0) {
+			/* sent after the receiver built this ACK */
+			continue;
+		}
+		if (d > LORA_LINK_WINDOW) {
+			/* outside the bitmap and never acked: it is gone */
+			slot->in_use = false;
+			expired++;
+			continue;
+		}
+
+		acked = (d == 0) || (bitmap & BIT(d - 1));
+		if (acked) {
+			slot->in_use = false;
+			acked_frames++;
+			acked_bytes += slot->len - LORA_LINK_HDR_LEN;
+			continue;
+		}
+
+		if (slot->retries >= LORA_LINK_MAX_RETRIES) {
+			slot->in_use = false;
+			expired++;
+			continue;
+		}
+
+		/* selective retransmit of the hole; keep the original seq, but as plain DATA:
+		 * the sender only listens after the batch's DATA_ACKREQ
+		 */
+		put_hdr(slot->frame, LORA_LINK_TYPE_DATA, slot->seq);
+		slot->retries++;
+		if (lora_send(_dev, slot->frame, slot->len) == 0) {
+			retransmits++;
+			LOG_DBG("retransmit seq %u (try %u)", slot->seq, slot->retries);
+		}
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&_lock);
+
+	_stats.rx_acks++;
+	_stats.tx_acked += acked_frames;
+	_stats.tx_acked_bytes += acked_bytes;
+	_stats.tx_expired += expired;
+	_stats.tx_retransmits += retransmits;
+	k_spin_unlock(&_lock, key);
+}
+
+int lora_link_poll_ack(k_timeout_t timeout)
+{
+	uint8_t buf[LORA_LINK_ACK_LEN];
+	int16_t rssi;
+	int8_t snr;
+	int ret, len;
+
+	ret = set_tx(false);
+	if (ret < 0) {
+		return ret;
+	}
+
+	len = lora_recv(_dev, buf, sizeof(buf), timeout, &rssi, &snr);
+	if (len < 0) {
+		return len; /* -EAGAIN on timeout */
+	}
+
+	if (len != LORA_LINK_ACK_LEN || (buf[0] >> 4) != LORA_LINK_VERSION ||
+	    (buf[0] & 0x0F) != LORA_LINK_TYPE_ACK || buf[LORA_LINK_HDR_LEN] != _node_id) {
+		return -EBADMSG;
+	}
+
+	/* retransmissions go out right away */
+	ret = set_tx(true);
+	if (ret < 0) {
+		return ret;
+	}
+
+	handle_ack(sys_get_le16(&buf[LORA_LINK_HDR_LEN + 1]),
+		   sys_get_le32(&buf[LORA_LINK_HDR_LEN + 3]));
+	return 0;
+}
+
+static struct peer_state *find_peer(uint8_t node)
+{
+	struct peer_state *free_slot = NULL;
+
+	for (size_t i = 0; i < LORA_LINK_MAX_PEERS; ++i) {
+		if (_peers[i].valid && _peers[i].node == node) {
+			return &_peers[i];
+		}
+		if (!_peers[i].valid && free_slot == NULL) {
+			free_slot = &_peers[i];
+		}
+	}
+	return free_slot;
+}
+
+/* Update the loss bitmap; returns true if this seq was not seen before */
+static bool peer_track(struct peer_state *p, uint16_t seq)
+{
+	int16_t d;
+
+	if (!p->valid) {
+		p->valid = true;
+		p->last_seq = seq;
+		p->bitmap = 0;
+		p->expected = 1;
+		return true;
+	}
+
+	d = (int16_t)(seq - p->last_seq);
+	if (d > 0) {
+		if (d <= LORA_LINK_WINDOW) {
+			p->bitmap = (d == LORA_LINK_WINDOW) ? 0 : (p->bitmap << d);
+			p->bitmap |= BIT(d - 1);
+		} else {
+			p->bitmap = 0;
+		}
+		p->expected += d;
+		p->last_seq = seq;
+		return true;
+	}
+
+	if (d == 0) {
+		return false;
+	}
+
+	/* older than last_seq: a retransmit filling a hole, or a duplicate */
+	int idx = -d - 1;
+
+	if (idx >= LORA_LINK_WINDOW || (p->bitmap & BIT(idx))) {
+		return false;
+	}
+	p->bitmap |= BIT(idx);
+	return true;
+}
+
+int lora_link_rx(const uint8_t *data, uint16_t size, struct lora_link_rx_info *info)
+{
+	struct peer_state *p;
+
+	if (size < LORA_LINK_HDR_LEN || (data[0] >> 4) != LORA_LINK_VERSION) {
+		return -EBADMSG;
+	}
+
+	info->type = data[0] & 0x0F;
+	info->src = data[1];
+	info->seq = sys_get_le16(&data[2]);
+	info->payload = &data[LORA_LINK_HDR_LEN];
+	info->payload_len = size - LORA_LINK_HDR_LEN;
+	info->duplicate = false;
+
+	if (info->type != LORA_LINK_TYPE_DATA && info->type != LORA_LINK_TYPE_DATA_ACKREQ) {
+		/* ACKs are consumed by lora_link_poll_ack() on the sending side */
+		return -ENOTSUP;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&_lock);
+
+	p = find_peer(info->src);
+	if (p == NULL) {
+		k_spin_unlock(&_lock, key);
+		return -ENOMEM;
+	}
+	p->node = info->src;
+
+	if (peer_track(p, info->seq)) {
+		p->received++;
+		p->bytes += info->payload_len;
+	} else {
+		p->duplicates++;
+		info->duplicate = true;
+	}
+
+	/* Only when asked: the sender listens right after a DATA_ACKREQ and at no other time */
+	if (info->type == LORA_LINK_TYPE_DATA_ACKREQ) {
+		p->ack_pending = true;
+	}
+
+	k_spin_unlock(&_lock, key);
+	return 0;
+}
+
+bool lora_link_ack_pending(void)
+{
+	bool pending = false;
+	k_spinlock_key_t key = k_spin_lock(&_lock);
+
+	for (size_t i = 0; i < LORA_LINK_MAX_PEERS; ++i) {
+		pending |= _peers[i].valid && _peers[i].ack_pending;
+	}
+
+	k_spin_unlock(&_lock, key);
+	return pending;
+}
+
+int lora_link_send_acks(void)
+{
+	uint8_t ack[LORA_LINK_ACK_LEN];
+	int ret = 0;
+
+	for (size_t i = 0; i < LORA_LINK_MAX_PEERS; ++i) {
+		k_spinlock_key_t key = k_spin_lock(&_lock);
+		struct peer_state *p = &_peers[i];
+
+		if (!p->valid || !p->ack_pending) {
+			k_spin_unlock(&_lock, key);
+			continue;
+		}
+
+		put_hdr(ack, LORA_LINK_TYPE_ACK, 0);
+		ack[LORA_LINK_HDR_LEN] = p->node;
+		sys_put_le16(p->last_seq, &ack[LORA_LINK_HDR_LEN + 1]);
+		sys_put_le32(p->bitmap, &ack[LORA_LINK_HDR_LEN + 3]);
+		p->ack_pending = false;
+		k_spin_unlock(&_lock, key);
+
+		ret = set_tx(true);
+		if (ret < 0) {
+			break;
+		}
+		ret = lora_send(_dev, ack, sizeof(ack));
+		if (ret < 0) {
+			break;
+		}
+		key = k_spin_lock(&_lock);
+		_stats.acks_sent++;
+		k_spin_unlock(&_lock, key);
+	}
+
+	int rx_ret = set_tx(false);
+
+	return ret < 0 ? ret : rx_ret;
+}
+
+void lora_link_get_stats(struct lora_link_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&_lock);
+
+	*stats = _stats;
+	stats->rx_frames = stats->rx_bytes = stats->rx_duplicates = stats->rx_expected = 0;
+	for (size_t i = 0; i < LORA_LINK_MAX_PEERS; ++i) {
+		if (!_peers[i].valid) {
+			continue;
+		}
+		stats->rx_frames += _peers[i].received;
+		stats->rx_bytes += _peers[i].bytes;
+		stats->rx_duplicates += _peers[i].duplicates;
+		stats->rx_expected += _peers[i].expected;
+	}
+
+	k_spin_unlock(&_lock, key);
+}
+
+uint32_t lora_link_tx_delivery_permille(const struct lora_link_stats *stats)
+{
+	if (stats->tx_frames == 0) {
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)stats->tx_acked * 1000U) / stats->tx_frames);
+}
+
+uint32_t lora_link_rx_delivery_permille(const struct lora_link_stats *stats)
+{
+	if (stats->rx_expected == 0) {
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)stats->rx_frames * 1000U) / stats->rx_expected);
+}
+
+/* Unique payload bits delivered per second since init (acked on TX, received on RX) */
+uint32_t lora_link_goodput_bps(const struct lora_link_stats *stats)
+{
+	int64_t elapsed_ms = k_uptime_get() - stats->start_ms;
+	uint32_t bytes = stats->tx_frames ? stats->tx_acked_bytes : stats->rx_bytes;
+
+	if (elapsed_ms <= 0) {
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)bytes * 8U * 1000U) / (uint64_t)elapsed_ms);
+}
@@ -0,0 +1,123 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* ===================== lora_link.h ===================== */
+
+#ifndef LORA_LINK_H
+#define LORA_LINK_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/lora.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Application-level framing on top of the raw LoRa driver.
+ *
+ * Every frame starts with a 4 byte header:
+ *   [0] version (high nibble) | type (low nibble)
+ *   [1] source node id
+ *   [2..3] sequence number, little endian, per source node
+ *
+ * DATA frames carry the application payload after the header.
+ * ACK frames carry: destination node id, highest sequence received (base)
+ * and a 32-bit bitmap where bit i set means (base - 1 - i) was received.
+ * ACKs are batch-only: the receiver answers a DATA_ACKREQ frame and nothing
+ * else, because the half-duplex sender only listens right after sending one
+ * (every LORA_LINK_ACK_BATCH frames). A gap is reported by the next ACK's
+ * bitmap. The sender retransmits only the frames the bitmap reports missing,
+ * out of a bounded retransmit buffer.
+ */
+
+#define LORA_LINK_VERSION 1
+#define LORA_LINK_HDR_LEN 4
+#define LORA_LINK_ACK_LEN (LORA_LINK_HDR_LEN + 7)
+#define LORA_LINK_WINDOW 32 /* bits in the ACK/loss bitmap */
+
+#ifndef LORA_LINK_MAX_PAYLOAD
+#define LORA_LINK_MAX_PAYLOAD 64
+#endif
+#ifndef LORA_LINK_RETX_DEPTH
+#define LORA_LINK_RETX_DEPTH 16 /* frames kept for selective retransmit */
+#endif
+#ifndef LORA_LINK_MAX_PEERS
+#define LORA_LINK_MAX_PEERS 4
+#endif
+#ifndef LORA_LINK_ACK_BATCH
+#define LORA_LINK_ACK_BATCH 4
+#endif
+#ifndef LORA_LINK_MAX_RETRIES
+#define LORA_LINK_MAX_RETRIES 3
+#endif
+
+BUILD_ASSERT(LORA_LINK_RETX_DEPTH <= LORA_LINK_WINDOW,
+	     "Retransmit buffer must fit inside the ACK bitmap window");
+
+enum lora_link_type {
+	LORA_LINK_TYPE_DATA = 0x1,
+	LORA_LINK_TYPE_DATA_ACKREQ = 0x2, /* data, and ack everything so far */
+	LORA_LINK_TYPE_ACK = 0x3,
+};
+
+/* What lora_link_rx() found in a received frame */
+struct lora_link_rx_info {
+	uint8_t type;
+	uint8_t src;
+	uint16_t seq;
+	const uint8_t *payload;
+	uint8_t payload_len;
+	bool duplicate;
+};
+
+struct lora_link_stats {
+	/* sender side */
+	uint32_t tx_frames;      /* unique DATA frames sent */
+	uint32_t tx_retransmits; /* DATA frames sent again after a NACK */
+	uint32_t tx_bytes;       /* payload bytes of unique frames */
+	uint32_t tx_acked;       /* frames confirmed by an ACK bitmap */
+	uint32_t tx_acked_bytes;
+	uint32_t tx_expired;     /* dropped from the buffer without an ACK */
+	uint32_t rx_acks;
+	/* receiver side, summed over all peers */
+	uint32_t rx_frames;      /* unique DATA frames delivered */
+	uint32_t rx_bytes;
+	uint32_t rx_duplicates;
+	uint32_t rx_expected;    /* span of sequence numbers seen */
+	uint32_t acks_sent;
+	int64_t start_ms;
+};
+
+/* Public API */
+int lora_link_init(const struct device *lora_dev, const struct lora_modem_config *config,
+		   uint8_t node_id);
+
+/* Frame payload with the next sequence number, keep it for retransmit, send it */
+int lora_link_send(const uint8_t *payload, uint8_t len, bool ack_req);
+
+/* Wait up to timeout for an ACK and retransmit whatever it reports missing */
+int lora_link_poll_ack(k_timeout_t timeout);
+
+/* Parse a received frame; safe to call from the lora_recv_async callback */
+int lora_link_rx(const uint8_t *data, uint16_t size, struct lora_link_rx_info *info);
+
+bool lora_link_ack_pending(void);
+
+/* Send batched ACKs to every peer that has one pending. Async reception must be stopped. */
+int lora_link_send_acks(void);
+
+void lora_link_get_stats(struct lora_link_stats *stats);
+uint32_t lora_link_tx_delivery_permille(const struct lora_link_stats *stats);
+uint32_t lora_link_rx_delivery_permille(const struct lora_link_stats *stats);
+uint32_t lora_link_goodput_bps(const struct lora_link_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LORA_LINK_H */
@@ -0,0 +1,489 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* ===================== lora_sim.c ===================== */
+
+/*
+ * Emulated LoRa radio for native_sim.
+ * - Implements lora_driver_api so lora/send and lora/receive run unchanged.
+ * - Every native_sim process on the host shares one "ether": frames are UDP
+ *   multicast datagrams on the loopback (see lora_sim_bottom.c).
+ * - TX blocks for the real time on air of the configured SF/BW/CR.
+ * - RX models path loss, RSSI jitter, SNR vs. the SF demodulation floor,
+ *   configurable random loss, collisions with a capture margin, and half
+ *   duplex (frames in the air while we transmit are lost).
+ * Run with the default CONFIG_NATIVE_SIM_SLOWDOWN_TO_REAL_TIME=y so airtime
+ * lines up between processes.
+ */
+
+#define DT_DRV_COMPAT zephyr_lora_sim
+
+#include "lora_sim.h"
+#include "lora_sim_bottom.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(lora_sim, CONFIG_LORA_LOG_LEVEL);
+
+#define LORA_SIM_MAX_AIR 8        /* frames overlapping in the air at once */
+#define LORA_SIM_CAPTURE_DB 6     /* stronger frame survives a collision by this margin */
+#define LORA_SIM_NOISE_FIGURE_DB 6
+#define LORA_SIM_MAX_SNR_DB 12
+#define LORA_SIM_POLL_MS 1
+#define LORA_SIM_STACK_SIZE 2048
+#define LORA_SIM_THREAD_PRIO K_PRIO_COOP(7)
+
+struct air_frame {
+	bool used;
+	bool lost;
+	uint64_t end_us;
+	int16_t rssi;
+	int8_t snr;
+	uint8_t len;
+	uint8_t data[LORA_SIM_MAX_LEN];
+};
+
+struct lora_sim_config {
+	uint16_t port;
+	uint8_t path_loss_db;
+	uint8_t loss_percent;
+};
+
+struct lora_sim_data {
+	const struct device *dev;
+	struct lora_modem_config modem;
+	bool configured;
+	int fd;
+	uint32_t id;
+	struct k_mutex lock;
+	struct air_frame air[LORA_SIM_MAX_AIR];
+	uint64_t tx_end_us;
+
+	/* synchronous reception */
+	struct k_sem rx_sem;
+	bool rx_waiting;
+	uint8_t *rx_buf;
+	uint8_t rx_size;
+	int rx_len;
+	int16_t rx_rssi;
+	int8_t rx_snr;
+
+	/* asynchronous reception / transmission */
+	lora_recv_cb async_cb;
+	void *async_user_data;
+	struct k_work_delayable tx_done_work;
+	struct k_poll_signal *tx_signal;
+
+	struct lora_sim_stats stats;
+	struct lora_sim_pkt pkt; /* scratch for the poll thread */
+
+	struct k_thread thread;
+	K_KERNEL_STACK_MEMBER(stack, LORA_SIM_STACK_SIZE);
+};
+
+static uint32_t bw_hz(enum lora_signal_bandwidth bw)
+{
+	switch (bw) {
+	case BW_250_KHZ:
+		return 250000;
+	case BW_500_KHZ:
+		return 500000;
+	case BW_125_KHZ:
+	default:
+		return 125000;
+	}
+}
+
+/* -174 dBm/Hz thermal floor + 10log10(BW) + receiver noise figure */
+static int16_t noise_floor_dbm(enum lora_signal_bandwidth bw)
+{
+	switch (bw) {
+	case BW_250_KHZ:
+		return -174 + 54 + LORA_SIM_NOISE_FIGURE_DB;
+	case BW_500_KHZ:
+		return -174 + 57 + LORA_SIM_NOISE_FIGURE_DB;
+	case BW_125_KHZ:
+	default:
+		return -174 + 51 + LORA_SIM_NOISE_FIGURE_DB;
+	}
+}
+
+/* SX127x datasheet demodulator floor, in tenths of dB: SF7 -7.5 ... SF12 -20 */
+static int snr_floor_tenths(enum lora_datarate sf)
+{
+	return -75 - 25 * ((int)sf - (int)SF_7);
+}
+
+uint32_t lora_sim_time_on_air_us(const struct lora_modem_config *config, uint32_t len)
+{
+	const int sf = config->datarate;
+	const int cr = config->coding_rate; /* 1..4 for 4/5..4/8 */
+	const uint64_t tsym_ns = (1000000000ULL << sf) / bw_hz(config->bandwidth);
+	/* low data rate optimisation above 16 ms symbols */
+	const int de = tsym_ns > 16000000ULL ? 1 : 0;
+	const int num = 8 * (int)len - 4 * sf + 28 + 16;
+	const int den = 4 * (sf - 2 * de);
+	const int blocks = num > 0 ? (num + den - 1) / den : 0;
+	const uint64_t payload_sym = 8 + (uint64_t)blocks * (cr + 4);
+	/* preamble + 4.25 symbols of sync word / SFD */
+	const uint64_t preamble_ns = ((uint64_t)config->preamble_len * 4 + 17) * tsym_ns / 4;
+
+	return (uint32_t)((preamble_ns + payload_sym * tsym_ns) / 1000);
+}
+
+static int16_t rssi_jitter(void)
+{
+	/* sum of three uniforms: roughly gaussian, +-3 dB */
+	int16_t j = 0;
+
+	for (int i = 0; i < 3; ++i) {
+		j += (int16_t)(lora_sim_bottom_rand() % 3) - 1;
+	}
+	return j;
+}
+
+/* A frame from another process starts now: put it in the air, resolve overlaps */
+static void air_add(struct lora_sim_data *data, const struct lora_sim_pkt *pkt,
+		    const struct lora_sim_config *cfg, uint64_t now)
+{
+	struct air_frame *f = NULL;
+	int snr;
+
+	for (size_t i = 0; i < LORA_SIM_MAX_AIR; ++i) {
+		if (!data->air[i].used) {
+			f = &data->air[i];
+			break;
+		}
+	}
+	if (f == NULL) {
+		data->stats.rx_collided++;
+		return;
+	}
+
+	f->used = true;
+	f->lost = false;
+	f->end_us = now + pkt->toa_us;
+	f->len = MIN(pkt->len, LORA_SIM_MAX_LEN);
+	memcpy(f->data, pkt->data, f->len);
+	f->rssi = (int16_t)pkt->tx_power - cfg->path_loss_db + rssi_jitter();
+	snr = f->rssi - noise_floor_dbm(pkt->bandwidth);
+	f->snr = (int8_t)CLAMP(snr, INT8_MIN, LORA_SIM_MAX_SNR_DB);
+
+	if (data->tx_end_us > now) {
+		f->lost = true;
+		data->stats.rx_half_duplex++;
+		return;
+	}
+
+	for (size_t i = 0; i < LORA_SIM_MAX_AIR; ++i) {
+		struct air_frame *g = &data->air[i];
+
+		if (g == f || !g->used || g->end_us <= now) {
+			continue;
+		}
+		if (f->rssi >= g->rssi + LORA_SIM_CAPTURE_DB) {
+			g->lost = true;
+		} else if (g->rssi >= f->rssi + LORA_SIM_CAPTURE_DB) {
+			f->lost = true;
+		} else {
+			f->lost = g->lost = true;
+		}
+	}
+}
+
+static void deliver(struct lora_sim_data *data, struct air_frame *f)
+{
+	if (data->modem.tx || (!data->rx_waiting && data->async_cb == NULL)) {
+		data->stats.rx_not_listening++;
+		return;
+	}
+
+	data->stats.rx_ok++;
+
+	if (data->async_cb != NULL) {
+		data->async_cb(data->dev, f->data, f->len, f->rssi, f->snr, data->async_user_data);
+		return;
+	}
+
+	data->rx_len = MIN(f->len, data->rx_size);
+	memcpy(data->rx_buf, f->data, data->rx_len);
+	data->rx_rssi = f->rssi;
+	data->rx_snr = f->snr;
+	data->rx_waiting = false;
+	k_sem_give(&data->rx_sem);
+}
+
+/* Frames whose last symbol has gone by are either delivered or dropped */
+static void air_resolve(struct lora_sim_data *data, const struct lora_sim_config *cfg,
+			uint64_t now)
+{
+	for (size_t i = 0; i < LORA_SIM_MAX_AIR; ++i) {
+		struct air_frame *f = &data->air[i];
+
+		if (!f->used || f->end_us > now) {
+			continue;
+		}
+		f->used = false;
+
+		if (f->lost) {
+			data->stats.rx_collided++;
+		} else if (f->snr * 10 < snr_floor_tenths(data->modem.datarate)) {
+			data->stats.rx_below_sens++;
+		} else if ((lora_sim_bottom_rand() % 100) < cfg->loss_percent) {
+			data->stats.rx_lost++;
+		} else {
+			deliver(data, f);
+		}
+	}
+}
+
+static void lora_sim_thread(void *p1, void *p2, void *p3)
+{
+	const struct device *dev = p1;
+	const struct lora_sim_config *cfg = dev->config;
+	struct lora_sim_data *data = dev->data;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		uint64_t now = lora_sim_bottom_now_us();
+		int n;
+
+		k_mutex_lock(&data->lock, K_FOREVER);
+
+		while ((n = lora_sim_bottom_recv(data->fd, &data->pkt, sizeof(data->pkt))) > 0) {
+			const struct lora_sim_pkt *pkt = &data->pkt;
+
+			if (n < (int)LORA_SIM_PKT_HDR_LEN || pkt->magic != LORA_SIM_MAGIC ||
+			    pkt->src == data->id) {
+				continue;
+			}
+			/* other channels or spreading factors are invisible to us */
+			if (!data->configured || pkt->frequency != data->modem.frequency ||
+			    pkt->datarate != data->modem.datarate ||
+			    pkt->bandwidth != data->modem.bandwidth) {
+				continue;
+			}
+			air_add(data, pkt, cfg, now);
+		}
+
+		air_resolve(data, cfg, now);
+
+		k_mutex_unlock(&data->lock);
+		k_sleep(K_MSEC(LORA_SIM_POLL_MS));
+	}
+}
+
+static int lora_sim_config(const struct device *dev, struct lora_modem_config *config)
+{
+	struct lora_sim_data *data = dev->data;
+
+	if (config->datarate < SF_7 || config->datarate > SF_12) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	data->modem = *config;
+	data->configured = true;
+	k_mutex_unlock(&data->lock);
+	return 0;
+}
+
+static int transmit(const struct device *dev, uint8_t *buf, uint32_t len, uint32_t *toa_us)
+{
+	const struct lora_sim_config *cfg = dev->config;
+	struct lora_sim_data *data = dev->data;
+	struct lora_sim_pkt pkt;
+	uint64_t now;
+	int ret;
+
+	if (!data->configured) {
+		return -EINVAL;
+	}
+	if (len > LORA_SIM_MAX_LEN) {
+		return -EMSGSIZE;
+	}
+
+	pkt.magic = LORA_SIM_MAGIC;
+	pkt.src = data->id;
+	pkt.frequency = data->modem.frequency;
+	pkt.datarate = data->modem.datarate;
+	pkt.bandwidth = data->modem.bandwidth;
+	pkt.coding_rate = data->modem.coding_rate;
+	pkt.tx_power = data->modem.tx_power;
+	pkt.toa_us = lora_sim_time_on_air_us(&data->modem, len);
+	pkt.len = (uint8_t)len;
+	memcpy(pkt.data, buf, len);
+
+	ret = lora_sim_bottom_send(data->fd, cfg->port, &pkt, LORA_SIM_PKT_HDR_LEN + len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	now = lora_sim_bottom_now_us();
+	data->tx_end_us = now + pkt.toa_us;
+	/* half duplex: anything already in the air is lost to us */
+	for (size_t i = 0; i < LORA_SIM_MAX_AIR; ++i) {
+		if (data->air[i].used && !data->air[i].lost) {
+			data->air[i].lost = true;
+			data->stats.rx_half_duplex++;
+		}
+	}
+	data->stats.tx_frames++;
+	data->stats.tx_airtime_ms += pkt.toa_us / 1000;
+	k_mutex_unlock(&data->lock);
+
+	*toa_us = pkt.toa_us;
+	return 0;
+}
+
+static int lora_sim_send(const struct device *dev, uint8_t *buf, uint32_t len)
+{
+	uint32_t toa_us;
+	int ret = transmit(dev, buf, len, &toa_us);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* like the SX127x, lora_send() returns once the last symbol is out */
+	k_sleep(K_USEC(toa_us));
+	return 0;
+}
+
+static void tx_done_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct lora_sim_data *data = CONTAINER_OF(dwork, struct lora_sim_data, tx_done_work);
+
+	if (data->tx_signal != NULL) {
+		k_poll_signal_raise(data->tx_signal, 0);
+		data->tx_signal = NULL;
+	}
+}
+
+static int lora_sim_send_async(const struct device *dev, uint8_t *buf, uint32_t len,
+			       struct k_poll_signal *async)
+{
+	struct lora_sim_data *data = dev->data;
+	uint32_t toa_us;
+	int ret = transmit(dev, buf, len, &toa_us);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	data->tx_signal = async;
+	k_work_reschedule(&data->tx_done_work, K_USEC(toa_us));
+	return 0;
+}
+
+static int lora_sim_recv(const struct device *dev, uint8_t *buf, uint8_t size,
+			 k_timeout_t timeout, int16_t *rssi, int8_t *snr)
+{
+	struct lora_sim_data *data = dev->data;
+	int ret;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	if (data->async_cb != NULL) {
+		k_mutex_unlock(&data->lock);
+		return -EBUSY;
+	}
+	k_sem_reset(&data->rx_sem);
+	data->rx_buf = buf;
+	data->rx_size = size;
+	data->rx_waiting = true;
+	k_mutex_unlock(&data->lock);
+
+	ret = k_sem_take(&data->rx_sem, timeout);
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	data->rx_waiting = false;
+	k_mutex_unlock(&data->lock);
+
+	if (ret < 0) {
+		return -EAGAIN;
+	}
+
+	if (rssi != NULL) {
+		*rssi = data->rx_rssi;
+	}
+	if (snr != NULL) {
+		*snr = data->rx_snr;
+	}
+	return data->rx_len;
+}
+
+static int lora_sim_recv_async(const struct device *dev, lora_recv_cb cb, void *user_data)
+{
+	struct lora_sim_data *data = dev->data;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	data->async_cb = cb;
+	data->async_user_data = user_data;
+	k_mutex_unlock(&data->lock);
+	return 0;
+}
+
+void lora_sim_get_stats(const struct device *dev, struct lora_sim_stats *stats)
+{
+	struct lora_sim_data *data = dev->data;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	*stats = data->stats;
+	k_mutex_unlock(&data->lock);
+}
+
+static const struct lora_driver_api lora_sim_api = {
+	.config = lora_sim_config,
+	.send = lora_sim_send,
+	.send_async = lora_sim_send_async,
+	.recv = lora_sim_recv,
+	.recv_async = lora_sim_recv_async,
+};
+
+static int lora_sim_init(const struct device *dev)
+{
+	const struct lora_sim_config *cfg = dev->config;
+	struct lora_sim_data *data = dev->data;
+
+	data->dev = dev;
+	data->id = lora_sim_bottom_id();
+	k_mutex_init(&data->lock);
+	k_sem_init(&data->rx_sem, 0, 1);
+	k_work_init_delayable(&data->tx_done_work, tx_done_handler);
+
+	data->fd = lora_sim_bottom_open(cfg->port);
+	if (data->fd < 0) {
+		LOG_ERR("Cannot join the simulated ether on port %u (%d)", cfg->port, data->fd);
+		return data->fd;
+	}
+
+	k_thread_create(&data->thread, data->stack, K_KERNEL_STACK_SIZEOF(data->stack),
+			lora_sim_thread, (void *)dev, NULL, NULL, LORA_SIM_THREAD_PRIO, 0,
+			K_NO_WAIT);
+	k_thread_name_set(&data->thread, dev->name);
+
+	LOG_INF("Emulated LoRa radio %08x on port %u, path loss %u dB, loss %u%%", data->id,
+		cfg->port, cfg->path_loss_db, cfg->loss_percent);
+	return 0;
+}
+
+#define LORA_SIM_DEFINE(inst)                                                                      \
+	static const struct lora_sim_config lora_sim_config_##inst = {                             \
+		.port = DT_INST_PROP(inst, udp_port),                                              \
+		.path_loss_db = DT_INST_PROP(inst, path_loss_db),                                  \
+		.loss_percent = DT_INST_PROP(inst, loss_percent),                                  \
+	};                                                                                         \
+	static struct lora_sim_data lora_sim_data_##inst;                                          \
+	DEVICE_DT_INST_DEFINE(inst, lora_sim_init, NULL, &lora_sim_data_##inst,                    \
+			      &lora_sim_config_##inst, POST_KERNEL, CONFIG_LORA_INIT_PRIORITY,     \
+			      &lora_sim_api);
+
+DT_INST_FOREACH_STATUS_OKAY(LORA_SIM_DEFINE)
@@ -0,0 +1,39 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* ===================== lora_sim.h ===================== */
+
+#ifndef LORA_SIM_H
+#define LORA_SIM_H
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/lora.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Counters kept by the emulated radio, for link benchmarks */
+struct lora_sim_stats {
+	uint32_t tx_frames;
+	uint32_t tx_airtime_ms;
+	uint32_t rx_ok;
+	uint32_t rx_collided;    /* overlapped a frame within the capture margin */
+	uint32_t rx_below_sens;  /* SNR under the demodulation floor for the SF */
+	uint32_t rx_lost;        /* dropped by the configured random loss */
+	uint32_t rx_half_duplex; /* arrived while we were transmitting */
+	uint32_t rx_not_listening;
+};
+
+/* Semtech AN1200.13 time on air, explicit header, CRC on */
+uint32_t lora_sim_time_on_air_us(const struct lora_modem_config *config, uint32_t len);
+
+void lora_sim_get_stats(const struct device *dev, struct lora_sim_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LORA_SIM_H */
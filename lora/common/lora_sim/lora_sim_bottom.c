@@ -0,0 +1,118 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* ===================== lora_sim_bottom.c ===================== */
+
+#include "lora_sim_bottom.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Administratively scoped group; IP_MULTICAST_TTL 0 keeps it on this host */
+#define LORA_SIM_GROUP "239.255.76.82"
+
+int lora_sim_bottom_open(uint16_t port)
+{
+	struct sockaddr_in addr;
+	struct ip_mreq mreq;
+	unsigned char loop = 1;
+	unsigned char ttl = 0;
+	int one = 1;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	/* every process on the host binds the same port */
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+	setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		goto err;
+	}
+
+	mreq.imr_multiaddr.s_addr = inet_addr(LORA_SIM_GROUP);
+	mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+	if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+		goto err;
+	}
+
+	struct in_addr ifaddr = {.s_addr = htonl(INADDR_LOOPBACK)};
+
+	setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &ifaddr, sizeof(ifaddr));
+	setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+	setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+	/* the simulated CPU must never block inside the host */
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	srand((unsigned int)(getpid() ^ lora_sim_bottom_now_us()));
+	return fd;
+
+err:
+	{
+		int err = errno;
+
+		close(fd);
+		return -err;
+	}
+}
+
+int lora_sim_bottom_send(int fd, uint16_t port, const void *buf, size_t len)
+{
+	struct sockaddr_in dst;
+
+	memset(&dst, 0, sizeof(dst));
+	dst.sin_family = AF_INET;
+	dst.sin_port = htons(port);
+	dst.sin_addr.s_addr = inet_addr(LORA_SIM_GROUP);
+
+	if (sendto(fd, buf, len, 0, (struct sockaddr *)&dst, sizeof(dst)) < 0) {
+		return -errno;
+	}
+	return (int)len;
+}
+
+int lora_sim_bottom_recv(int fd, void *buf, size_t len)
+{
+	ssize_t n = recv(fd, buf, len, 0);
+
+	if (n < 0) {
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -errno;
+	}
+	return (int)n;
+}
+
+uint64_t lora_sim_bottom_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+uint32_t lora_sim_bottom_rand(void)
+{
+	return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+uint32_t lora_sim_bottom_id(void)
+{
+	return (uint32_t)getpid();
+}
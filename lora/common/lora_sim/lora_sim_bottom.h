@@ -0,0 +1,56 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* ===================== lora_sim_bottom.h ===================== */
+
+/*
+ * Host side of the emulated LoRa radio. This half is built against the host
+ * libc (native_simulator) and must not include any Zephyr header; the driver
+ * in lora_sim.c only talks to it through these calls.
+ */
+
+#ifndef LORA_SIM_BOTTOM_H
+#define LORA_SIM_BOTTOM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LORA_SIM_MAGIC 0x4C6F5261u /* "LoRa" */
+#define LORA_SIM_MAX_LEN 255
+
+/* One over-the-air frame as exchanged between native_sim processes */
+struct lora_sim_pkt {
+	uint32_t magic;
+	uint32_t src;       /* sending process, used to drop our own frames */
+	uint32_t frequency;
+	uint32_t toa_us;    /* time on air computed by the sender */
+	uint8_t datarate;
+	uint8_t bandwidth;
+	uint8_t coding_rate;
+	int8_t tx_power;
+	uint8_t len;
+	uint8_t data[LORA_SIM_MAX_LEN];
+} __attribute__((packed));
+
+#define LORA_SIM_PKT_HDR_LEN (sizeof(struct lora_sim_pkt) - LORA_SIM_MAX_LEN)
+
+/* Join the shared "ether" (UDP multicast on the loopback). Returns fd or -errno */
+int lora_sim_bottom_open(uint16_t port);
+int lora_sim_bottom_send(int fd, uint16_t port, const void *buf, size_t len);
+/* Non-blocking: returns bytes read, 0 if nothing pending, -errno on error */
+int lora_sim_bottom_recv(int fd, void *buf, size_t len);
+/* Host monotonic clock, shared by every process on the machine */
+uint64_t lora_sim_bottom_now_us(void);
+uint32_t lora_sim_bottom_rand(void);
+uint32_t lora_sim_bottom_id(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LORA_SIM_BOTTOM_H */
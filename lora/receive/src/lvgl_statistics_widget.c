@@ -1,9 +1,15 @@
 /*
  * lvgl_statistics_widget.h/.c and lvgl_sensor_widget.h/.c
  * Compact, KISS C modules for Zephyr + LVGL
- * - Message API: each msg placed on module's k_msgq is struct widget_msg { uint8_t opcode; uint8_t length; uint8_t data[64]; }
- * - Uses Zephyr kernel primitives (k_msgq, k_thread, k_mutex, k_timer) and LVGL objects (chart, labels, containers)
- * - Safe-ish: GUI updates are performed from LVGL timers (lv_timer_cb), message thread updates protected by mutex.
+ * - Counter API: producers call stat_widget_count(opcode, n) from any context (threads or ISRs);
+ *   each opcode is one atomic_t, no queue, no thread, no mutex, nothing to overflow.
+ *   struct widget_msg { uint8_t opcode; uint8_t length; uint8_t data[64]; } is still accepted by stat_widget_post().
+ * - Uses Zephyr atomics and LVGL objects (chart, labels, containers)
+ * - Safe-ish: GUI updates are performed from LVGL timers (lv_timer_cb), which sample-and-reset the counters with atomic_clear().
+ * - Dirty tracking: the chart runs in circular mode and a changed sample goes in with lv_chart_set_next_value(),
+ *   which invalidates only the points around it (lv_chart_set_value_by_id() would refresh the whole chart);
+ *   an unchanged one just moves the write position. Labels are only re-set when their value changes,
+ *   so an idle link costs no redraw (each full SSD1306 frame is ~1 KB over I2C).
  * - Designed to be included in a Zephyr LVGL app (see usage at bottom)
  *
  * Files contained in this single document:
@@ -18,18 +24,16 @@
 /* ===================== lvgl_statistics_widget.c ===================== */
 
 #include "lvgl_statistics_widget.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(stat_widget, LOG_LEVEL_DBG);
 
 /* Internal storage sizes */
 #define STAT_HISTORY_LEN 60 /* seconds of history */
 
-static struct k_msgq _msgq;
-static char _msgq_buffer[STAT_WIDGET_MSGQ_ITEMS * sizeof(struct widget_msg)];
-static struct k_thread _msgq_thread_data;
-static K_THREAD_STACK_DEFINE(_msgq_stack, 2048);
-static struct k_mutex _data_lock;
-
 /* LVGL objects */
 static lv_obj_t *chart;
 static lv_chart_series_t *series_ble;
@@ -39,10 +43,10 @@ static lv_obj_t *lbl_ble;
 static lv_obj_t *lbl_lora;
 static lv_obj_t *lbl_wifi;
 
-/* running counters */
-static uint32_t counters_ble;
-static uint32_t counters_lora;
-static uint32_t counters_wifi;
+/* running counters, bumped lock-free by producers */
+static atomic_t counters_ble;
+static atomic_t counters_lora;
+static atomic_t counters_wifi;
 
 /* history arrays for plotting */
 static uint32_t history_ble[STAT_HISTORY_LEN];
@@ -50,15 +54,19 @@ static uint32_t history_lora[STAT_HISTORY_LEN];
 static uint32_t history_wifi[STAT_HISTORY_LEN];
 static size_t history_idx;
 
+/* last values shown on the labels (init text is "0/s") */
+static uint32_t shown_ble;
+static uint32_t shown_lora;
+static uint32_t shown_wifi;
+
 /* forward */
-static void msgq_thread(void *p1, void *p2, void *p3);
 static void lv_tick_cb(lv_timer_t *t);
 
 int stat_widget_init(lv_obj_t *parent)
 {
-    /* create msgq */
-    k_msgq_init(&_msgq, _msgq_buffer, sizeof(struct widget_msg), STAT_WIDGET_MSGQ_ITEMS);
-    k_mutex_init(&_data_lock);
+    atomic_clear(&counters_ble);
+    atomic_clear(&counters_lora);
+    atomic_clear(&counters_wifi);
 
     /* create chart */
     chart = lv_chart_create(parent);
@@ -69,11 +77,15 @@ int stat_widget_init(lv_obj_t *parent)
     lv_chart_set_div_line_count(chart, 0, 0);
     lv_obj_set_style_bg_opa(chart, LV_OPA_TRANSP, LV_PART_MAIN);
     lv_obj_set_style_line_width(chart, 0, LV_PART_MAIN);
-    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
+    /* circular: point i is drawn at column i and each series' start point is the next one written */
+    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_CIRCULAR);
 
     series_ble = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
     series_lora = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_GREEN), LV_CHART_AXIS_PRIMARY_Y);
     series_wifi = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_all_value(chart, series_ble, 0);
+    lv_chart_set_all_value(chart, series_lora, 0);
+    lv_chart_set_all_value(chart, series_wifi, 0);
 
     lbl_ble = lv_label_create(parent);
     lv_obj_align(lbl_ble, LV_ALIGN_TOP_RIGHT, -2, 2);
@@ -95,103 +107,100 @@ int stat_widget_init(lv_obj_t *parent)
     }
     history_idx = 0;
 
-    /* start worker thread to consume msgq */
-    k_thread_create(&_msgq_thread_data, _msgq_stack, K_THREAD_STACK_SIZEOF(_msgq_stack), msgq_thread,
-                    NULL, NULL, NULL, K_PRIO_PREEMPT(10), 0, K_NO_WAIT);
-
     /* start lv_timer for GUI updates (1s) */
     lv_timer_create(lv_tick_cb, 1000, NULL);
 
     return 0;
 }
 
-struct k_msgq *stat_widget_msgq(void)
+static atomic_t *counter_for(uint8_t opcode)
+{
+    switch (opcode) {
+    case STAT_OPCODE_BLE:
+        return &counters_ble;
+    case STAT_OPCODE_LORA:
+        return &counters_lora;
+    case STAT_OPCODE_WIFI:
+        return &counters_wifi;
+    default:
+        return NULL;
+    }
+}
+
+/* Lock-free, callable from ISRs: one atomic add per event */
+void stat_widget_count(enum stat_opcode opcode, uint32_t n)
 {
-    return &_msgq;
+    atomic_t *ctr;
+
+    if (opcode == STAT_OPCODE_RESET) {
+        atomic_clear(&counters_ble);
+        atomic_clear(&counters_lora);
+        atomic_clear(&counters_wifi);
+        return;
+    }
+
+    ctr = counter_for(opcode);
+    if (ctr != NULL) {
+        atomic_add(ctr, (atomic_val_t)n);
+    }
 }
 
-/* Worker thread: read messages and update counters */
-static void msgq_thread(void *p1, void *p2, void *p3)
+/* Message-style entry point, decoded in the caller's context */
+int stat_widget_post(const struct widget_msg *msg)
 {
-    ARG_UNUSED(p1);
-    ARG_UNUSED(p2);
-    ARG_UNUSED(p3);
-    struct widget_msg msg;
-
-    while (1) {
-        if (k_msgq_get(&_msgq, &msg, K_FOREVER) == 0) {
-            k_mutex_lock(&_data_lock, K_FOREVER);
-            switch (msg.opcode) {
-            case STAT_OPCODE_BLE: {
-                if (msg.length >= sizeof(uint32_t)) {
-                    uint32_t v;
-                    memcpy(&v, msg.data, sizeof(uint32_t));
-                    counters_ble += v;
-                }
-                break;
-            }
-            case STAT_OPCODE_LORA: {
-                if (msg.length >= sizeof(uint32_t)) {
-                    uint32_t v;
-                    memcpy(&v, msg.data, sizeof(uint32_t));
-                    counters_lora += v;
-                }
-                break;
-            }
-            case STAT_OPCODE_WIFI: {
-                if (msg.length >= sizeof(uint32_t)) {
-                    uint32_t v;
-                    memcpy(&v, msg.data, sizeof(uint32_t));
-                    counters_wifi += v;
-                }
-                break;
-            }
-            case STAT_OPCODE_RESET:
-                counters_ble = counters_lora = counters_wifi = 0;
-                break;
-            default:
-                /* ignore */
-                break;
-            }
-            k_mutex_unlock(&_data_lock);
+    uint32_t v = 0;
+
+    if (msg->opcode != STAT_OPCODE_RESET) {
+        if (counter_for(msg->opcode) == NULL || msg->length < sizeof(uint32_t)) {
+            return -EINVAL;
         }
+        memcpy(&v, msg->data, sizeof(uint32_t));
     }
+    stat_widget_count(msg->opcode, v);
+    return 0;
+}
+
+/* Write one history slot; only set a value (and so invalidate its points) if it changed */
+static void update_point(lv_chart_series_t *ser, uint32_t *history, uint32_t v)
+{
+    if (history[history_idx] == v) {
+        /* keep the series' write position in step with history_idx, no redraw */
+        lv_chart_set_x_start_point(chart, ser, (history_idx + 1) % STAT_HISTORY_LEN);
+        return;
+    }
+    history[history_idx] = v;
+    lv_chart_set_next_value(chart, ser, v);
+}
+
+/* Re-render a label only when the value it shows changed */
+static void update_label(lv_obj_t *lbl, uint32_t *shown, const char *name, uint32_t v)
+{
+    char tmp[32];
+
+    if (*shown == v) {
+        return;
+    }
+    *shown = v;
+    snprintf(tmp, sizeof(tmp), "%s: %u/s", name, v);
+    lv_label_set_text(lbl, tmp);
 }
 
 /* LVGL timer: called once per second to snapshot counters and update chart */
 static void lv_tick_cb(lv_timer_t *t)
 {
     ARG_UNUSED(t);
-    uint32_t b, l, w;
-    k_mutex_lock(&_data_lock, K_FOREVER);
-    b = counters_ble; l = counters_lora; w = counters_wifi;
-    counters_ble = counters_lora = counters_wifi = 0; /* reset per-second counters */
-    k_mutex_unlock(&_data_lock);
-
-    /* push into history ring buffer */
-    history_ble[history_idx] = b;
-    history_lora[history_idx] = l;
-    history_wifi[history_idx] = w;
+    /* sample and reset per-second counters in one atomic swap each */
+    uint32_t b = (uint32_t)atomic_clear(&counters_ble);
+    uint32_t l = (uint32_t)atomic_clear(&counters_lora);
+    uint32_t w = (uint32_t)atomic_clear(&counters_wifi);
+
+    /* history slot == each series' start point (the next point written) in circular mode */
+    update_point(series_ble, history_ble, b);
+    update_point(series_lora, history_lora, l);
+    update_point(series_wifi, history_wifi, w);
     history_idx = (history_idx + 1) % STAT_HISTORY_LEN;
 
-    /* update chart series: LVGL expects arrays in chronological order */
-    // for (size_t i = 0; i < STAT_HISTORY_LEN; ++i) {
-    //     size_t idx = (history_idx + i) % STAT_HISTORY_LEN;
-    //     lv_chart_set_next_value(chart, series_ble, history_ble[idx]);
-    //     lv_chart_set_next_value(chart, series_lora, history_lora[idx]);
-    //     lv_chart_set_next_value(chart, series_wifi, history_wifi[idx]);
-    // }
-    lv_chart_set_next_value(chart, series_ble, b);
-    lv_chart_set_next_value(chart, series_lora, l);
-    lv_chart_set_next_value(chart, series_wifi, w);
-    lv_chart_refresh(chart);
-
-    /* update labels */
-    char tmp[32];
-    snprintf(tmp, sizeof(tmp), "BLE: %u/s", b);
-    lv_label_set_text(lbl_ble, tmp);
-    snprintf(tmp, sizeof(tmp), "LoRa: %u/s", l);
-    lv_label_set_text(lbl_lora, tmp);
-    snprintf(tmp, sizeof(tmp), "WiFi: %u/s", w);
-    lv_label_set_text(lbl_wifi, tmp);
+    update_label(lbl_ble, &shown_ble, "BLE", b);
+    update_label(lbl_lora, &shown_lora, "LoRa", l);
+    update_label(lbl_wifi, &shown_wifi, "WiFi", w);
 }
@@ -8,10 +8,9 @@
 #include <lvgl.h>
 #include <stdint.h>
 
-#define STAT_WIDGET_MSGQ_ITEMS 16
 #define STAT_WIDGET_MSG_PAYLOAD 64
 
-/* Message structure placed into the widget's k_msgq */
+/* Message structure accepted by stat_widget_post() */
 struct widget_msg {
     uint8_t opcode;
     uint8_t length; /* valid payload length */
@@ -28,6 +27,9 @@ enum stat_opcode {
 
 /* Public API */
 int stat_widget_init(lv_obj_t *parent);
-struct k_msgq *stat_widget_msgq(void); /* return pointer to internal msgq for outsiders to put messages */
+/* add n events to an opcode's per-second counter; lock-free, safe from ISRs */
+void stat_widget_count(enum stat_opcode opcode, uint32_t n);
+/* same, from a struct widget_msg (data: uint32_t count); -EINVAL on unknown opcode */
+int stat_widget_post(const struct widget_msg *msg);
 
 #endif /* LVGL_STATISTICS_WIDGET_H */
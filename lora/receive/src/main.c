@@ -22,12 +22,18 @@
 static uint32_t count;
 
 #include "lvgl_statistics_widget.h"
+#include "lora_link.h"
 
 #define DEFAULT_RADIO_NODE DT_ALIAS(lora0)
 BUILD_ASSERT(DT_NODE_HAS_STATUS_OKAY(DEFAULT_RADIO_NODE),
 	     "No default LoRa radio specified in DT");
 
 #define MAX_DATA_LEN 255
+#define LORA_NODE_ID 0x80
+#define STATS_PERIOD_MS 30000
+
+/* Wakes the UI/radio loop before its next LVGL deadline */
+static K_SEM_DEFINE(wake_sem, 0, 1);
 
 #define LOG_LEVEL CONFIG_LOG_DEFAULT_LEVEL
 #include <zephyr/logging/log.h>
@@ -37,13 +43,19 @@ void lora_receive_cb(const struct device *dev, uint8_t *data, uint16_t size,
 		     int16_t rssi, int8_t snr, void *user_data)
 {
 	static int cnt;
+	struct lora_link_rx_info info;
 
 	ARG_UNUSED(dev);
-	ARG_UNUSED(size);
 	ARG_UNUSED(user_data);
 
-	LOG_INF("LoRa RX RSSI: %d dBm, SNR: %d dB", rssi, snr);
-	LOG_HEXDUMP_INF(data, size, "LoRa RX payload");
+	if (lora_link_rx(data, size, &info) < 0) {
+		LOG_WRN("Dropping unframed packet (%u bytes)", size);
+		return;
+	}
+
+	LOG_INF("LoRa RX node %u seq %u%s RSSI: %d dBm, SNR: %d dB", info.src, info.seq,
+		info.duplicate ? " (dup)" : "", rssi, snr);
+	LOG_HEXDUMP_INF(info.payload, info.payload_len, "LoRa RX payload");
 
 	/* Stop receiving after 1000000 packets */
 	if (++cnt == 1000000) {
@@ -51,9 +63,13 @@ void lora_receive_cb(const struct device *dev, uint8_t *data, uint16_t size,
 		lora_recv_async(dev, NULL, NULL);
 	}
 
-	static struct widget_msg m;
-	m.opcode = STAT_OPCODE_LORA; m.length = 4; memcpy(m.data, &cnt, 4);
-	k_msgq_put(stat_widget_msgq(), &m, K_NO_WAIT);
+	if (!info.duplicate) {
+		stat_widget_count(STAT_OPCODE_LORA, 1);
+	}
+
+	if (lora_link_ack_pending()) {
+		k_sem_give(&wake_sem);
+	}
 	
 }
 
@@ -102,7 +118,7 @@ int main(void)
 	config.tx_power = 14;
 	config.tx = false;
 
-	ret = lora_config(lora_dev, &config);
+	ret = lora_link_init(lora_dev, &config, LORA_NODE_ID);
 	if (ret < 0) {
 		LOG_ERR("LoRa config failed");
 		return 0;
@@ -112,9 +128,36 @@ int main(void)
 	LOG_INF("Asynchronous reception");
 	lora_recv_async(lora_dev, lora_receive_cb, NULL);
 
+    int64_t next_stats = k_uptime_get() + STATS_PERIOD_MS;
+    struct lora_link_stats stats;
+
     while (1) {
-        lv_timer_handler();
-        k_sleep(K_MSEC(10));
+        /* ms until the next LVGL timer, LV_NO_TIMER_READY if none */
+        uint32_t sleep_ms = lv_timer_handler();
+
+        /* Radio is half duplex: pause reception while batched ACKs go out */
+        if (lora_link_ack_pending()) {
+            lora_recv_async(lora_dev, NULL, NULL);
+            ret = lora_link_send_acks();
+            if (ret < 0) {
+                LOG_WRN("ACK send failed (%d)", ret);
+            }
+            lora_recv_async(lora_dev, lora_receive_cb, NULL);
+        }
+
+        if (k_uptime_get() >= next_stats) {
+            next_stats += STATS_PERIOD_MS;
+            lora_link_get_stats(&stats);
+            LOG_INF("rx %u/%u dup %u acks %u delivery %u.%u%% goodput %u bps",
+                    stats.rx_frames, stats.rx_expected, stats.rx_duplicates,
+                    stats.acks_sent, lora_link_rx_delivery_permille(&stats) / 10,
+                    lora_link_rx_delivery_permille(&stats) % 10,
+                    lora_link_goodput_bps(&stats));
+        }
+
+        /* Sleep until LVGL has work, stats are due, or the radio needs an ACK out */
+        sleep_ms = MIN(sleep_ms, (uint32_t)MAX(next_stats - k_uptime_get(), 0));
+        k_sem_take(&wake_sem, K_MSEC(sleep_ms));
     }
 	
 	return 0;
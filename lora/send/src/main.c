@@ -10,11 +10,16 @@
 #include <zephyr/sys/util.h>
 #include <zephyr/kernel.h>
 
+#include "lora_link.h"
+
 #define DEFAULT_RADIO_NODE DT_ALIAS(lora0)
 BUILD_ASSERT(DT_NODE_HAS_STATUS_OKAY(DEFAULT_RADIO_NODE),
 	     "No default LoRa radio specified in DT");
 
 #define MAX_DATA_LEN 12
+#define LORA_NODE_ID 0x01
+#define ACK_TIMEOUT_MS 3000
+#define STATS_EVERY 10
 
 #define LOG_LEVEL CONFIG_LOG_DEFAULT_LEVEL
 #include <zephyr/logging/log.h>
@@ -43,14 +48,23 @@ int main(void)
 	config.tx_power = 4;
 	config.tx = true;
 
-	ret = lora_config(lora_dev, &config);
+	ret = lora_link_init(lora_dev, &config, LORA_NODE_ID);
 	if (ret < 0) {
 		LOG_ERR("LoRa config failed");
 		return 0;
 	}
 
+	uint32_t sent = 0;
+	struct lora_link_stats stats;
+
 	while (1) {
-		ret = lora_send(lora_dev, data, MAX_DATA_LEN);
+		/*
+		 * Ask for a batched ACK once every LORA_LINK_ACK_BATCH frames. This is the only
+		 * time the sender listens, and the receiver never ACKs unasked.
+		 */
+		bool ack_req = ((++sent % LORA_LINK_ACK_BATCH) == 0);
+
+		ret = lora_link_send(data, MAX_DATA_LEN, ack_req);
 		if (ret < 0) {
 			LOG_ERR("LoRa send failed");
 			return 0;
@@ -58,6 +72,22 @@ int main(void)
 
 		LOG_INF("Data sent %c!", data[MAX_DATA_LEN - 1]);
 
+		if (ack_req) {
+			ret = lora_link_poll_ack(K_MSEC(ACK_TIMEOUT_MS));
+			if (ret < 0) {
+				LOG_WRN("No ACK (%d)", ret);
+			}
+		}
+
+		if ((sent % STATS_EVERY) == 0) {
+			lora_link_get_stats(&stats);
+			LOG_INF("sent %u retx %u acked %u expired %u delivery %u.%u%% goodput %u bps",
+				stats.tx_frames, stats.tx_retransmits, stats.tx_acked,
+				stats.tx_expired, lora_link_tx_delivery_permille(&stats) / 10,
+				lora_link_tx_delivery_permille(&stats) % 10,
+				lora_link_goodput_bps(&stats));
+		}
+
 		/* Send data at 1s interval */
 		k_sleep(K_MSEC(15000));
 